@@ -64,6 +64,16 @@ public:
     MODE_VERIFY,    // compare
   };
 
+  // Position and size of an array within the state.
+  struct LargeArray
+  {
+    size_t offset;
+    size_t size;
+  };
+
+  // Arrays of at least this size (e.g. emulated RAM) are recorded by RecordLargeArrays().
+  static constexpr u32 LARGE_ARRAY_SIZE = 0x10000;
+
   u8** ptr;
   Mode mode;
 
@@ -71,6 +81,21 @@ public:
   PointerWrap(u8** ptr_, Mode mode_) : ptr(ptr_), mode(mode_) {}
   void SetMode(Mode mode_) { mode = mode_; }
   Mode GetMode() const { return mode; }
+  // Records all large arrays from now on, with offsets relative to the current position.
+  // Delta savestates use them to line up two states of the same game.
+  void RecordLargeArrays(std::vector<LargeArray>* arrays)
+  {
+    m_large_arrays = arrays;
+    m_large_arrays_start = *ptr;
+  }
+  // Writes no further than end. Once something doesn't fit, the mode changes to MODE_MEASURE,
+  // and *ptr ends up where the end of the whole state would have been.
+  void SetWriteLimit(u8* end)
+  {
+    m_write_end = end;
+    m_write_limited = true;
+  }
+
   template <typename K, class V>
   void Do(std::map<K, V>& x)
   {
@@ -273,6 +298,9 @@ private:
 
   __forceinline void DoVoid(void* data, u32 size)
   {
+    if (m_large_arrays && size >= LARGE_ARRAY_SIZE)
+      m_large_arrays->push_back({static_cast<size_t>(*ptr - m_large_arrays_start), size});
+
     switch (mode)
     {
     case MODE_READ:
@@ -280,7 +308,10 @@ private:
       break;
 
     case MODE_WRITE:
-      memcpy(*ptr, data, size);
+      if (m_write_limited && size > static_cast<size_t>(m_write_end - *ptr))
+        mode = MODE_MEASURE;
+      else
+        memcpy(*ptr, data, size);
       break;
 
     case MODE_MEASURE:
@@ -295,4 +326,9 @@ private:
 
     *ptr += size;
   }
+
+  std::vector<LargeArray>* m_large_arrays = nullptr;
+  u8* m_large_arrays_start = nullptr;
+  u8* m_write_end = nullptr;
+  bool m_write_limited = false;
 };
@@ -24,7 +24,7 @@ private:
   // A privately used function to set the executable RAM space to something invalid.
   // For debugging usefulness it should be used to set the RAM to a host specific breakpoint
   // instruction
-  virtual void PoisonMemory() = 0;
+  virtual void PoisonMemory(u8* ptr, size_t size) = 0;
 
 protected:
   u8* region = nullptr;
@@ -36,6 +36,11 @@ protected:
   bool m_is_child = false;
   std::vector<CodeBlock*> m_children;
 
+  // The region can be split into equally sized segments. Code is only emitted into the
+  // current segment, so that the others stay intact when a segment is cleared and reused.
+  size_t m_num_segments = 1;
+  size_t m_segment = 0;
+
 public:
   virtual ~CodeBlock()
   {
@@ -56,7 +61,7 @@ public:
   // uninitialized, it just breaks into the debugger.
   void ClearCodeSpace()
   {
-    PoisonMemory();
+    PoisonMemory(region, region_size);
     ResetCodePtr();
   }
 
@@ -80,11 +85,16 @@ public:
   // Cannot currently be undone. Will write protect the entire code region.
   // Start over if you need to change the code (call FreeCodeSpace(), AllocCodeSpace()).
   void WriteProtect() { Common::WriteProtectMemory(region, region_size, true); }
-  void ResetCodePtr() { T::SetCodePtr(region); }
+  void ResetCodePtr()
+  {
+    m_segment = 0;
+    T::SetCodePtr(region);
+  }
   size_t GetSpaceLeft() const
   {
-    _assert_(static_cast<size_t>(T::GetCodePtr() - region) < region_size);
-    return region_size - (T::GetCodePtr() - region);
+    const u8* segment_end = GetSegmentStart(m_segment) + GetSegmentSize();
+    _assert_(T::GetCodePtr() >= GetSegmentStart(m_segment) && T::GetCodePtr() < segment_end);
+    return segment_end - T::GetCodePtr();
   }
 
   bool IsAlmostFull() const
@@ -93,6 +103,26 @@ public:
     return GetSpaceLeft() < 0x10000;
   }
 
+  // Call this after all children have been allocated. Resets the code pointer.
+  void SetSegmentCount(size_t num_segments)
+  {
+    _assert_(num_segments > 0);
+    m_num_segments = num_segments;
+    ResetCodePtr();
+  }
+  size_t GetSegmentCount() const { return m_num_segments; }
+  size_t GetSegmentSize() const { return region_size / m_num_segments; }
+  size_t GetCurrentSegment() const { return m_segment; }
+  u8* GetSegmentStart(size_t segment) const { return region + segment * GetSegmentSize(); }
+  // Clears a single segment and continues emitting code at its start.
+  void ClearSegment(size_t segment)
+  {
+    _assert_(segment < m_num_segments);
+    PoisonMemory(GetSegmentStart(segment), GetSegmentSize());
+    m_segment = segment;
+    T::SetCodePtr(GetSegmentStart(segment));
+  }
+
   bool HasChildren() const { return region_size != total_region_size; }
   u8* AllocChildCodeSpace(size_t child_size)
   {
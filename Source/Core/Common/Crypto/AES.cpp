@@ -4,7 +4,9 @@
 
 #include <mbedtls/aes.h>
 
+#include "Common/CPUDetect.h"
 #include "Common/Crypto/AES.h"
+#include "Common/Intrinsics.h"
 
 namespace Common
 {
@@ -35,5 +37,122 @@ std::vector<u8> Encrypt(const u8* key, u8* iv, const u8* src, size_t size)
 {
   return DecryptEncrypt(key, iv, src, size, Mode::Encrypt);
 }
+
+#if defined(_M_X86)
+namespace
+{
+template <int rcon>
+FUNCTION_TARGET_AES __m128i ExpandKey(__m128i key)
+{
+  const __m128i assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key, rcon), 0xff);
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, assist);
+}
+
+// Stores the round keys for decryption, which are the encryption round keys in reverse order
+// with InvMixColumns applied to all but the first and the last one.
+FUNCTION_TARGET_AES void ExpandDecryptionKeys(const u8* key, u8* round_keys)
+{
+  __m128i keys[11];
+  keys[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+  keys[1] = ExpandKey<0x01>(keys[0]);
+  keys[2] = ExpandKey<0x02>(keys[1]);
+  keys[3] = ExpandKey<0x04>(keys[2]);
+  keys[4] = ExpandKey<0x08>(keys[3]);
+  keys[5] = ExpandKey<0x10>(keys[4]);
+  keys[6] = ExpandKey<0x20>(keys[5]);
+  keys[7] = ExpandKey<0x40>(keys[6]);
+  keys[8] = ExpandKey<0x80>(keys[7]);
+  keys[9] = ExpandKey<0x1b>(keys[8]);
+  keys[10] = ExpandKey<0x36>(keys[9]);
+
+  __m128i* out = reinterpret_cast<__m128i*>(round_keys);
+  _mm_store_si128(&out[0], keys[10]);
+  for (int i = 1; i < 10; i++)
+    _mm_store_si128(&out[i], _mm_aesimc_si128(keys[10 - i]));
+  _mm_store_si128(&out[10], keys[0]);
+}
+
+FUNCTION_TARGET_AES void DecryptAESNI(const u8* round_keys, u8* iv, const u8* src, u8* dst,
+                                      size_t size)
+{
+  __m128i keys[11];
+  for (int i = 0; i < 11; i++)
+    keys[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(round_keys) + i);
+
+  const __m128i* in = reinterpret_cast<const __m128i*>(src);
+  __m128i* out = reinterpret_cast<__m128i*>(dst);
+  const size_t num_blocks = size / 16;
+  __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+
+  // The latency of AESDEC is much higher than its throughput, so work on four blocks at a time.
+  size_t i = 0;
+  for (; i + 4 <= num_blocks; i += 4)
+  {
+    const __m128i c0 = _mm_loadu_si128(&in[i]);
+    const __m128i c1 = _mm_loadu_si128(&in[i + 1]);
+    const __m128i c2 = _mm_loadu_si128(&in[i + 2]);
+    const __m128i c3 = _mm_loadu_si128(&in[i + 3]);
+    __m128i b0 = _mm_xor_si128(c0, keys[0]);
+    __m128i b1 = _mm_xor_si128(c1, keys[0]);
+    __m128i b2 = _mm_xor_si128(c2, keys[0]);
+    __m128i b3 = _mm_xor_si128(c3, keys[0]);
+    for (int round = 1; round < 10; round++)
+    {
+      b0 = _mm_aesdec_si128(b0, keys[round]);
+      b1 = _mm_aesdec_si128(b1, keys[round]);
+      b2 = _mm_aesdec_si128(b2, keys[round]);
+      b3 = _mm_aesdec_si128(b3, keys[round]);
+    }
+    b0 = _mm_aesdeclast_si128(b0, keys[10]);
+    b1 = _mm_aesdeclast_si128(b1, keys[10]);
+    b2 = _mm_aesdeclast_si128(b2, keys[10]);
+    b3 = _mm_aesdeclast_si128(b3, keys[10]);
+    _mm_storeu_si128(&out[i], _mm_xor_si128(b0, previous));
+    _mm_storeu_si128(&out[i + 1], _mm_xor_si128(b1, c0));
+    _mm_storeu_si128(&out[i + 2], _mm_xor_si128(b2, c1));
+    _mm_storeu_si128(&out[i + 3], _mm_xor_si128(b3, c2));
+    previous = c3;
+  }
+
+  for (; i < num_blocks; i++)
+  {
+    const __m128i c = _mm_loadu_si128(&in[i]);
+    __m128i b = _mm_xor_si128(c, keys[0]);
+    for (int round = 1; round < 10; round++)
+      b = _mm_aesdec_si128(b, keys[round]);
+    b = _mm_aesdeclast_si128(b, keys[10]);
+    _mm_storeu_si128(&out[i], _mm_xor_si128(b, previous));
+    previous = c;
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(iv), previous);
+}
+}  // Anonymous namespace
+#endif
+
+CBCDecryptor::CBCDecryptor(const u8* key)
+{
+#if defined(_M_X86)
+  m_use_aesni = cpu_info.bAES;
+  if (m_use_aesni)
+    ExpandDecryptionKeys(key, m_round_keys.data());
+#endif
+  mbedtls_aes_setkey_dec(&m_context, key, 128);
+}
+
+void CBCDecryptor::Decrypt(u8* iv, const u8* src, u8* dst, size_t size) const
+{
+#if defined(_M_X86)
+  if (m_use_aesni)
+  {
+    DecryptAESNI(m_round_keys.data(), iv, src, dst, size);
+    return;
+  }
+#endif
+  mbedtls_aes_crypt_cbc(&m_context, MBEDTLS_AES_DECRYPT, size, iv, src, dst);
+}
 }  // namespace AES
 }  // namespace Common
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <mbedtls/aes.h>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -23,5 +25,25 @@ std::vector<u8> DecryptEncrypt(const u8* key, u8* iv, const u8* src, size_t size
 // Convenience functions
 std::vector<u8> Decrypt(const u8* key, u8* iv, const u8* src, size_t size);
 std::vector<u8> Encrypt(const u8* key, u8* iv, const u8* src, size_t size);
+
+// AES-128-CBC decryption for large amounts of data. CBC decryption doesn't depend on the previous
+// plaintext, so when the CPU supports AES-NI several blocks are decrypted at once.
+class CBCDecryptor
+{
+public:
+  explicit CBCDecryptor(const u8* key);
+  CBCDecryptor(const CBCDecryptor&) = delete;
+  CBCDecryptor& operator=(const CBCDecryptor&) = delete;
+
+  // Works like mbedtls_aes_crypt_cbc: size has to be a multiple of 16, iv is updated,
+  // and src and dst may be the same.
+  void Decrypt(u8* iv, const u8* src, u8* dst, size_t size) const;
+
+private:
+  bool m_use_aesni = false;
+  alignas(16) std::array<u8, 11 * 16> m_round_keys{};
+  // mbedtls doesn't modify the context, it just isn't declared const.
+  mutable mbedtls_aes_context m_context;
+};
 }  // namespace AES
 }  // namespace Common
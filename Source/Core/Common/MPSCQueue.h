@@ -0,0 +1,161 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// A lockless thread-safe, multiple writer, single reader queue.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+// Writers claim cells of a bounded ring with a compare-and-swap, and each cell has a sequence
+// number which tells the reader when its value has been written.
+// When the ring is full, writers don't wait for the reader. They add to a spill list under a
+// lock instead, and keep doing so until the reader has drained the spill list. The values of
+// each writer are therefore read in the order it wrote them.
+template <typename T, size_t Capacity>
+class MPSCQueue
+{
+  static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+
+public:
+  MPSCQueue()
+  {
+    for (size_t i = 0; i < Capacity; ++i)
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  template <typename Arg>
+  void Push(Arg&& value)
+  {
+    if (!m_spilling.load(std::memory_order_acquire) && TryPushToRing(std::forward<Arg>(value)))
+      return;
+
+    // Publishes the ring writes of this thread to a reader which sees the flag.
+    std::lock_guard<std::mutex> lk(m_spill_lock);
+    m_spilling.store(true, std::memory_order_release);
+    m_spill.push_back(std::forward<Arg>(value));
+    m_spilled_pushes.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Must only be called from the reader thread.
+  bool Pop(T& value)
+  {
+    if (m_spill_index == m_spill_read.size())
+    {
+      if (TryPopFromRing(value))
+        return true;
+
+      // Values only spill while the ring is full, so the spill list must wait until every value
+      // which was written to the ring before it has been read.
+      if (!m_spilling.load(std::memory_order_acquire) ||
+          m_write_pos.load(std::memory_order_acquire) != m_read_pos)
+      {
+        return false;
+      }
+
+      std::lock_guard<std::mutex> lk(m_spill_lock);
+      // A writer which read the flag before it was set can have claimed a cell since then, and
+      // have spilled its next value after that. Taking the lock makes that claim visible here.
+      if (m_write_pos.load(std::memory_order_relaxed) != m_read_pos)
+        return TryPopFromRing(value);
+
+      m_spill_read.clear();
+      m_spill_read.swap(m_spill);
+      m_spill_index = 0;
+      m_spilling.store(false, std::memory_order_release);
+      if (m_spill_read.empty())
+        return false;
+    }
+
+    value = std::move(m_spill_read[m_spill_index++]);
+    return true;
+  }
+
+  // Not thread-safe.
+  void Clear()
+  {
+    T value;
+    while (Pop(value))
+    {
+    }
+  }
+
+  // Counters for profiling how often writers got in each other's way or found the ring full.
+  u64 GetContendedPushCount() const { return m_contended_pushes.load(std::memory_order_relaxed); }
+  u64 GetSpilledPushCount() const { return m_spilled_pushes.load(std::memory_order_relaxed); }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  bool TryPopFromRing(T& value)
+  {
+    Cell& cell = m_cells[m_read_pos & (Capacity - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) != m_read_pos + 1)
+      return false;
+
+    value = std::move(cell.value);
+    cell.sequence.store(m_read_pos + Capacity, std::memory_order_release);
+    m_read_pos++;
+    return true;
+  }
+
+  template <typename Arg>
+  bool TryPushToRing(Arg&& value)
+  {
+    size_t pos = m_write_pos.load(std::memory_order_relaxed);
+    while (true)
+    {
+      Cell& cell = m_cells[pos & (Capacity - 1)];
+      const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      if (sequence == pos)
+      {
+        if (m_write_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          cell.value = std::forward<Arg>(value);
+          cell.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+        m_contended_pushes.fetch_add(1, std::memory_order_relaxed);
+      }
+      else if (sequence < pos)
+      {
+        // The reader hasn't freed this cell yet, so the ring is full.
+        return false;
+      }
+      else
+      {
+        pos = m_write_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  std::array<Cell, Capacity> m_cells;
+  alignas(64) std::atomic<size_t> m_write_pos{0};
+  alignas(64) size_t m_read_pos = 0;
+
+  std::atomic<bool> m_spilling{false};
+  std::mutex m_spill_lock;
+  std::vector<T> m_spill;
+  // Only accessed by the reader.
+  std::vector<T> m_spill_read;
+  size_t m_spill_index = 0;
+
+  std::atomic<u64> m_contended_pushes{0};
+  std::atomic<u64> m_spilled_pushes{0};
+};
+}
@@ -52,8 +52,13 @@ static int AshmemCreateFileMapping(const char* name, size_t size)
 }
 #endif
 
-void MemArena::GrabSHMSegment(size_t size)
+#if defined(__linux__) && !defined(ANDROID) && defined(MFD_CLOEXEC) && defined(MADV_HUGEPAGE)
+#define HAS_SHMEM_HUGE_PAGES
+#endif
+
+void MemArena::GrabSHMSegment(size_t size, bool use_huge_pages)
 {
+  m_use_huge_pages = false;
 #ifdef _WIN32
   hMemoryMapping =
       CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, (DWORD)(size), nullptr);
@@ -65,6 +70,23 @@ void MemArena::GrabSHMSegment(size_t size)
     return;
   }
 #else
+#ifdef HAS_SHMEM_HUGE_PAGES
+  // shm_open creates the segment on /dev/shm, which is usually mounted without huge page support.
+  // A memfd lives on the kernel's internal shmem mount, which honours MADV_HUGEPAGE when
+  // /sys/kernel/mm/transparent_hugepage/shmem_enabled is set to advise.
+  if (use_huge_pages)
+  {
+    fd = memfd_create("dolphinmem", MFD_CLOEXEC);
+    if (fd != -1 && ftruncate(fd, size) == 0)
+    {
+      m_use_huge_pages = true;
+      return;
+    }
+    ERROR_LOG(MEMMAP, "Failed to create a huge page backed memory segment: %s", strerror(errno));
+    if (fd != -1)
+      close(fd);
+  }
+#endif
   for (int i = 0; i < 10000; i++)
   {
     std::string file_name = StringFromFormat("/dolphinmem.%d", i);
@@ -93,6 +115,7 @@ void MemArena::ReleaseSHMSegment()
 #else
   close(fd);
 #endif
+  m_use_huge_pages = false;
 }
 
 void* MemArena::CreateView(s64 offset, size_t size, void* base)
@@ -108,10 +131,15 @@ void* MemArena::CreateView(s64 offset, size_t size, void* base)
     NOTICE_LOG(MEMMAP, "mmap failed");
     return nullptr;
   }
-  else
-  {
-    return retval;
-  }
+
+#ifdef HAS_SHMEM_HUGE_PAGES
+  // Small views are advised too, so that adjacent views of the same range get merged into one
+  // mapping which can use huge pages.
+  if (m_use_huge_pages && madvise(retval, size, MADV_HUGEPAGE) != 0)
+    WARN_LOG(MEMMAP, "madvise(MADV_HUGEPAGE) failed: %s", strerror(errno));
+#endif
+
+  return retval;
 #endif
 }
 
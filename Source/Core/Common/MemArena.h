@@ -20,11 +20,19 @@
 class MemArena
 {
 public:
-  void GrabSHMSegment(size_t size);
+  // Views whose offset and address are both aligned to this can be backed by huge pages.
+  static constexpr size_t HUGE_PAGE_SIZE = 0x200000;
+
+  // If use_huge_pages is set, the host is asked to back the views with transparent huge pages,
+  // which cuts down on TLB misses for accesses spread over all of emulated RAM. This is a hint:
+  // if the host doesn't support it, the segment is backed by normal pages.
+  void GrabSHMSegment(size_t size, bool use_huge_pages = false);
   void ReleaseSHMSegment();
   void* CreateView(s64 offset, size_t size, void* base = nullptr);
   void ReleaseView(void* view, size_t size);
 
+  // Whether the views are hinted to be backed by huge pages.
+  bool UsesHugePages() const { return m_use_huge_pages; }
   // This finds 1 GB in 32-bit, 16 GB in 64-bit.
   static u8* FindMemoryBase();
 
@@ -34,4 +42,5 @@ private:
 #else
   int fd;
 #endif
+  bool m_use_huge_pages = false;
 };
@@ -1045,6 +1045,13 @@ public:
     ABI_CallFunction(func);
   }
 
+  template <typename FunctionPointer>
+  void ABI_CallFunctionP(FunctionPointer func, const void* param1)
+  {
+    MOV(64, R(ABI_PARAM1), Imm64(reinterpret_cast<u64>(param1)));
+    ABI_CallFunction(func);
+  }
+
   template <typename FunctionPointer>
   void ABI_CallFunctionC(FunctionPointer func, u32 param1)
   {
@@ -1181,10 +1188,10 @@ public:
 class X64CodeBlock : public CodeBlock<XEmitter>
 {
 private:
-  void PoisonMemory() override
+  void PoisonMemory(u8* ptr, size_t size) override
   {
     // x86/64: 0xCC = breakpoint
-    memset(region, 0xCC, region_size);
+    memset(ptr, 0xCC, size);
   }
 };
 
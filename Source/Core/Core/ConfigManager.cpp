@@ -242,6 +242,7 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("TimingVariance", iTimingVariance);
   core->Set("CPUCore", iCPUCore);
   core->Set("Fastmem", bFastmem);
+  core->Set("HugePages", bHugePages);
   core->Set("CPUThread", bCPUThread);
   core->Set("DSPHLE", bDSPHLE);
   core->Set("SyncOnSkipIdle", bSyncGPUOnSkipIdleHack);
@@ -251,6 +252,9 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("SyncGpuOverclock", fSyncGpuOverclock);
   core->Set("FPRF", bFPRF);
   core->Set("AccurateNaNs", bAccurateNaNs);
+  core->Set("JITPersistentBlockList", bJITPersistentBlockList);
+  core->Set("JITTraceFormation", bJITTraceFormation);
+  core->Set("JITProfileGuidedRecompile", bJITProfileGuidedRecompile);
   core->Set("DefaultISO", m_strDefaultISO);
   core->Set("EnableCheats", bEnableCheats);
   core->Set("SelectedLanguage", SelectedLanguage);
@@ -279,6 +283,11 @@ void SConfig::SaveCoreSettings(IniFile& ini)
   core->Set("WiimoteEnableSpeaker", m_WiimoteEnableSpeaker);
   core->Set("RunCompareServer", bRunCompareServer);
   core->Set("RunCompareClient", bRunCompareClient);
+  core->Set("Rewind", bRewind);
+  core->Set("RewindInterval", iRewindInterval);
+  core->Set("RewindMemory", iRewindMemory);
+  core->Set("DeltaSavestates", bDeltaSavestates);
+  core->Set("DiscCacheSize", iDiscCacheSize);
   core->Set("EmulationSpeed", m_EmulationSpeed);
   core->Set("FrameSkip", m_FrameSkip);
   core->Set("Overclock", m_OCFactor);
@@ -561,6 +570,7 @@ void SConfig::LoadCoreSettings(IniFile& ini)
   core->Get("CPUCore", &iCPUCore, PowerPC::CORE_INTERPRETER);
 #endif
   core->Get("Fastmem", &bFastmem, true);
+  core->Get("HugePages", &bHugePages, false);
   core->Get("DSPHLE", &bDSPHLE, true);
   core->Get("TimingVariance", &iTimingVariance, 40);
   core->Get("CPUThread", &bCPUThread, true);
@@ -605,6 +615,14 @@ void SConfig::LoadCoreSettings(IniFile& ini)
   core->Get("LowDCBZHack", &bLowDCBZHack, false);
   core->Get("FPRF", &bFPRF, false);
   core->Get("AccurateNaNs", &bAccurateNaNs, false);
+  core->Get("JITPersistentBlockList", &bJITPersistentBlockList, false);
+  core->Get("JITTraceFormation", &bJITTraceFormation, false);
+  core->Get("JITProfileGuidedRecompile", &bJITProfileGuidedRecompile, false);
+  core->Get("Rewind", &bRewind, false);
+  core->Get("RewindInterval", &iRewindInterval, 30);
+  core->Get("RewindMemory", &iRewindMemory, 256);
+  core->Get("DeltaSavestates", &bDeltaSavestates, false);
+  core->Get("DiscCacheSize", &iDiscCacheSize, 16);
   core->Get("EmulationSpeed", &m_EmulationSpeed, 1.0f);
   core->Get("Overclock", &m_OCFactor, 1.0f);
   core->Get("OverclockEnable", &m_OCEnable, false);
@@ -822,6 +840,7 @@ void SConfig::LoadDefaults()
   bRunCompareServer = false;
   bDSPHLE = true;
   bFastmem = true;
+  bHugePages = false;
   bFPRF = false;
   bAccurateNaNs = false;
   bMMU = false;
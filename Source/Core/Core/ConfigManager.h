@@ -91,8 +91,12 @@ struct SConfig : NonCopyable
   bool bJITPairedOff = false;
   bool bJITSystemRegistersOff = false;
   bool bJITBranchOff = false;
+  bool bJITPersistentBlockList = false;
+  bool bJITTraceFormation = false;
+  bool bJITProfileGuidedRecompile = false;
 
   bool bFastmem;
+  bool bHugePages = false;
   bool bFPRF = false;
   bool bAccurateNaNs = false;
 
@@ -121,6 +125,14 @@ struct SConfig : NonCopyable
   int iBBDumpPort = 0;
   bool bFastDiscSpeed = false;
 
+  bool bRewind = false;
+  int iRewindInterval = 30;  // in fields
+  int iRewindMemory = 256;   // in MiB
+
+  bool bDeltaSavestates = false;
+
+  int iDiscCacheSize = 16;  // in MiB
+
   bool bSyncGPU = false;
   int iSyncGpuMaxDistance;
   int iSyncGpuMinDistance;
@@ -5,16 +5,20 @@
 #include "Core/CoreTiming.h"
 
 #include <algorithm>
+#include <array>
 #include <cinttypes>
+#include <limits>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "Common/Assert.h"
+#include "Common/BitSet.h"
 #include "Common/ChunkFile.h"
-#include "Common/FifoQueue.h"
 #include "Common/Logging/Log.h"
+#include "Common/MPSCQueue.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
 
@@ -27,10 +31,14 @@
 
 namespace CoreTiming
 {
+static constexpr u32 INVALID_EVENT_INDEX = std::numeric_limits<u32>::max();
+
 struct EventType
 {
   TimedCallback callback;
   const std::string* name;
+  // The events of this type which are in the queue, linked through EventNode::next_of_type.
+  u32 first_event = INVALID_EVENT_INDEX;
 };
 
 struct Event
@@ -42,28 +50,337 @@ struct Event
 };
 
 // Sort by time, unless the times are the same, in which case sort by the order added to the queue
-static bool operator>(const Event& left, const Event& right)
-{
-  return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
-}
 static bool operator<(const Event& left, const Event& right)
 {
   return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
 }
 
+// Pending events are kept in a timer wheel. Each slot holds the events of SLOT_LENGTH cycles in
+// an unsorted list, so scheduling and removing an event never has to touch the other events.
+// The slot at the base of the wheel additionally holds the events which are already due, and
+// events too far in the future for the wheel wait in an overflow list until the wheel gets
+// close enough to them. Hot events are rescheduled every few thousand cycles, so the slots stay
+// short and finding the next event is a bitmap scan plus a walk over a handful of events.
+class EventQueue
+{
+public:
+  EventQueue() { m_slots.fill(INVALID_EVENT_INDEX); }
+
+  EventHandle Push(const Event& event);
+  // Returns the earliest event, or nullptr if the queue is empty.
+  const Event* Peek();
+  // Removes the event returned by the last call to Peek.
+  void Pop();
+  void Remove(EventHandle handle);
+  void RemoveAll(EventType* type);
+  // Removes all events. Handles to them stay stale, and the wheel starts over at the given time.
+  void Clear(s64 time);
+  // Changes the time of every event, without making their handles stale.
+  template <typename Function>
+  void Retime(s64 time, Function get_new_time);
+
+  bool IsEmpty() const { return m_free_count == m_nodes.size(); }
+  std::vector<Event> GetSortedEvents() const;
+
+private:
+  static constexpr u32 SLOT_SHIFT = 12;
+  static constexpr u32 NUM_SLOTS = 512;
+  static constexpr u32 SLOT_MASK = NUM_SLOTS - 1;
+  static constexpr u32 OVERFLOW_SLOT = NUM_SLOTS;
+  static constexpr u32 FREE_SLOT = NUM_SLOTS + 1;
+
+  struct EventNode
+  {
+    Event event;
+    u32 generation = 0;
+    u32 slot = FREE_SLOT;
+    // Links within the slot or the overflow list, or within the free list.
+    u32 prev = INVALID_EVENT_INDEX;
+    u32 next = INVALID_EVENT_INDEX;
+    u32 prev_of_type = INVALID_EVENT_INDEX;
+    u32 next_of_type = INVALID_EVENT_INDEX;
+  };
+
+  static s64 GetSlotTime(s64 time) { return time >> SLOT_SHIFT; }
+
+  u32& ListHead(u32 slot) { return slot == OVERFLOW_SLOT ? m_overflow : m_slots[slot]; }
+  void Link(u32 index);
+  void Unlink(u32 index);
+  void Free(u32 index);
+  // Empties the slots and the overflow list, without touching the nodes.
+  void ResetWheel(s64 time);
+  void MoveBase(s64 base);
+  u32 FindOccupiedSlotOffset() const;
+
+  std::vector<EventNode> m_nodes;
+  u32 m_first_free = INVALID_EVENT_INDEX;
+  size_t m_free_count = 0;
+
+  // The slot time which the slot at index (m_base & SLOT_MASK) stands for.
+  s64 m_base = 0;
+  std::array<u32, NUM_SLOTS> m_slots;
+  std::array<u64, NUM_SLOTS / 64> m_occupied_slots{};
+  u32 m_wheel_count = 0;
+
+  u32 m_overflow = INVALID_EVENT_INDEX;
+  s64 m_overflow_min_slot_time = std::numeric_limits<s64>::max();
+
+  u32 m_peeked = INVALID_EVENT_INDEX;
+};
+
+EventHandle EventQueue::Push(const Event& event)
+{
+  u32 index;
+  if (m_first_free != INVALID_EVENT_INDEX)
+  {
+    index = m_first_free;
+    m_first_free = m_nodes[index].next;
+    m_free_count--;
+  }
+  else
+  {
+    index = static_cast<u32>(m_nodes.size());
+    m_nodes.emplace_back();
+  }
+
+  EventNode& node = m_nodes[index];
+  node.event = event;
+  Link(index);
+
+  node.prev_of_type = INVALID_EVENT_INDEX;
+  node.next_of_type = event.type->first_event;
+  if (node.next_of_type != INVALID_EVENT_INDEX)
+    m_nodes[node.next_of_type].prev_of_type = index;
+  event.type->first_event = index;
+
+  m_peeked = INVALID_EVENT_INDEX;
+  return {index, node.generation};
+}
+
+const Event* EventQueue::Peek()
+{
+  if (m_peeked != INVALID_EVENT_INDEX)
+    return &m_nodes[m_peeked].event;
+
+  while (m_wheel_count == 0)
+  {
+    if (m_overflow == INVALID_EVENT_INDEX)
+      return nullptr;
+    MoveBase(m_overflow_min_slot_time);
+  }
+
+  // The slots between the base and the first occupied one are empty, so the base can skip them.
+  const u32 offset = FindOccupiedSlotOffset();
+  if (offset != 0)
+    MoveBase(m_base + offset);
+
+  u32 best = m_slots[m_base & SLOT_MASK];
+  for (u32 index = m_nodes[best].next; index != INVALID_EVENT_INDEX; index = m_nodes[index].next)
+  {
+    if (m_nodes[index].event < m_nodes[best].event)
+      best = index;
+  }
+
+  m_peeked = best;
+  return &m_nodes[best].event;
+}
+
+void EventQueue::Pop()
+{
+  _dbg_assert_(POWERPC, m_peeked != INVALID_EVENT_INDEX);
+  Free(m_peeked);
+}
+
+void EventQueue::Remove(EventHandle handle)
+{
+  if (handle.index < m_nodes.size() && m_nodes[handle.index].slot != FREE_SLOT &&
+      m_nodes[handle.index].generation == handle.generation)
+  {
+    Free(handle.index);
+  }
+}
+
+void EventQueue::RemoveAll(EventType* type)
+{
+  while (type->first_event != INVALID_EVENT_INDEX)
+    Free(type->first_event);
+}
+
+void EventQueue::Clear(s64 time)
+{
+  m_first_free = INVALID_EVENT_INDEX;
+  for (u32 index = static_cast<u32>(m_nodes.size()); index-- > 0;)
+  {
+    EventNode& node = m_nodes[index];
+    if (node.slot != FREE_SLOT)
+    {
+      node.event.type->first_event = INVALID_EVENT_INDEX;
+      node.generation++;
+      node.slot = FREE_SLOT;
+    }
+    node.next = m_first_free;
+    m_first_free = index;
+  }
+  m_free_count = m_nodes.size();
+
+  ResetWheel(time);
+}
+
+template <typename Function>
+void EventQueue::Retime(s64 time, Function get_new_time)
+{
+  ResetWheel(time);
+  for (u32 index = 0; index < m_nodes.size(); index++)
+  {
+    EventNode& node = m_nodes[index];
+    if (node.slot == FREE_SLOT)
+      continue;
+
+    node.event.time = get_new_time(node.event.time);
+    Link(index);
+  }
+}
+
+void EventQueue::ResetWheel(s64 time)
+{
+  m_base = GetSlotTime(time);
+  m_slots.fill(INVALID_EVENT_INDEX);
+  m_occupied_slots.fill(0);
+  m_wheel_count = 0;
+  m_overflow = INVALID_EVENT_INDEX;
+  m_overflow_min_slot_time = std::numeric_limits<s64>::max();
+  m_peeked = INVALID_EVENT_INDEX;
+}
+
+std::vector<Event> EventQueue::GetSortedEvents() const
+{
+  std::vector<Event> events;
+  for (const EventNode& node : m_nodes)
+  {
+    if (node.slot != FREE_SLOT)
+      events.push_back(node.event);
+  }
+  std::sort(events.begin(), events.end());
+  return events;
+}
+
+void EventQueue::Link(u32 index)
+{
+  EventNode& node = m_nodes[index];
+  const s64 slot_time = GetSlotTime(node.event.time);
+  if (slot_time - m_base >= NUM_SLOTS)
+  {
+    node.slot = OVERFLOW_SLOT;
+    m_overflow_min_slot_time = std::min(m_overflow_min_slot_time, slot_time);
+  }
+  else
+  {
+    // Events which are already due go into the base slot.
+    node.slot = static_cast<u32>(std::max(slot_time, m_base) & SLOT_MASK);
+    m_occupied_slots[node.slot / 64] |= u64(1) << (node.slot % 64);
+    m_wheel_count++;
+  }
+
+  u32& head = ListHead(node.slot);
+  node.prev = INVALID_EVENT_INDEX;
+  node.next = head;
+  if (head != INVALID_EVENT_INDEX)
+    m_nodes[head].prev = index;
+  head = index;
+}
+
+void EventQueue::Unlink(u32 index)
+{
+  EventNode& node = m_nodes[index];
+  if (node.prev != INVALID_EVENT_INDEX)
+    m_nodes[node.prev].next = node.next;
+  else
+    ListHead(node.slot) = node.next;
+  if (node.next != INVALID_EVENT_INDEX)
+    m_nodes[node.next].prev = node.prev;
+
+  if (node.slot == OVERFLOW_SLOT)
+  {
+    // The minimum is only a lower bound, which is tightened when the base moves.
+    if (m_overflow == INVALID_EVENT_INDEX)
+      m_overflow_min_slot_time = std::numeric_limits<s64>::max();
+  }
+  else
+  {
+    if (m_slots[node.slot] == INVALID_EVENT_INDEX)
+      m_occupied_slots[node.slot / 64] &= ~(u64(1) << (node.slot % 64));
+    m_wheel_count--;
+  }
+}
+
+void EventQueue::Free(u32 index)
+{
+  Unlink(index);
+
+  EventNode& node = m_nodes[index];
+  if (node.prev_of_type != INVALID_EVENT_INDEX)
+    m_nodes[node.prev_of_type].next_of_type = node.next_of_type;
+  else
+    node.event.type->first_event = node.next_of_type;
+  if (node.next_of_type != INVALID_EVENT_INDEX)
+    m_nodes[node.next_of_type].prev_of_type = node.prev_of_type;
+
+  // Makes outstanding handles to this event stale.
+  node.generation++;
+  node.slot = FREE_SLOT;
+  node.next = m_first_free;
+  m_first_free = index;
+  m_free_count++;
+
+  m_peeked = INVALID_EVENT_INDEX;
+}
+
+// Must only skip empty slots, since the events in them would end up in the wrong slot time.
+void EventQueue::MoveBase(s64 base)
+{
+  m_base = base;
+  if (m_overflow_min_slot_time - m_base >= NUM_SLOTS)
+    return;
+
+  u32 index = m_overflow;
+  m_overflow = INVALID_EVENT_INDEX;
+  m_overflow_min_slot_time = std::numeric_limits<s64>::max();
+  while (index != INVALID_EVENT_INDEX)
+  {
+    const u32 next = m_nodes[index].next;
+    Link(index);
+    index = next;
+  }
+}
+
+// Returns how many slots after the base the first occupied one is.
+u32 EventQueue::FindOccupiedSlotOffset() const
+{
+  const u32 start = static_cast<u32>(m_base) & SLOT_MASK;
+  for (u32 offset = 0; offset < NUM_SLOTS;)
+  {
+    const u32 slot = (start + offset) & SLOT_MASK;
+    const u64 bits = m_occupied_slots[slot / 64] >> (slot % 64);
+    if (bits != 0)
+      return offset + LeastSignificantSetBit(bits);
+    offset += 64 - slot % 64;
+  }
+  return NUM_SLOTS;
+}
+
 // unordered_map stores each element separately as a linked list node so pointers to elements
 // remain stable regardless of rehashes/resizing.
 static std::unordered_map<std::string, EventType> s_event_types;
 
 // STATE_TO_SAVE
-// The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-// We don't use std::priority_queue because we need to be able to serialize, unserialize and
-// erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't accomodated
-// by the standard adaptor class.
-static std::vector<Event> s_event_queue;
+static EventQueue s_event_queue;
 static u64 s_event_fifo_id;
-static std::mutex s_ts_write_lock;
-static Common::FifoQueue<Event, false> s_ts_queue;
+// Events scheduled from other threads, which MoveEvents adds to the queue on the CPU thread.
+static Common::MPSCQueue<Event, 1024> s_ts_queue;
+// Writers only share this lock, so they still don't wait for each other. DoState and Shutdown
+// take it exclusively, so that no event arrives while the queue is being saved or replaced.
+// (std::shared_mutex would do, but it is C++17 only.)
+static std::shared_timed_mutex s_ts_write_lock;
 
 static float s_last_OC_factor;
 static constexpr int MAX_SLICE_LENGTH = 20000;
@@ -109,7 +426,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
                "during Init to avoid breaking save states.",
                name.c_str());
 
-  auto info = s_event_types.emplace(name, EventType{callback, nullptr});
+  auto info = s_event_types.emplace(name, EventType{callback, nullptr, INVALID_EVENT_INDEX});
   EventType* event_type = &info.first->second;
   event_type->name = &info.first->first;
   return event_type;
@@ -117,7 +434,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-  _assert_msg_(POWERPC, s_event_queue.empty(), "Cannot unregister events with events pending");
+  _assert_msg_(POWERPC, s_event_queue.IsEmpty(), "Cannot unregister events with events pending");
   s_event_types.clear();
 }
 
@@ -142,7 +459,7 @@ void Init()
 
 void Shutdown()
 {
-  std::lock_guard<std::mutex> lk(s_ts_write_lock);
+  std::lock_guard<std::shared_timed_mutex> lk(s_ts_write_lock);
   MoveEvents();
   ClearPendingEvents();
   UnregisterAllEvents();
@@ -150,7 +467,7 @@ void Shutdown()
 
 void DoState(PointerWrap& p)
 {
-  std::lock_guard<std::mutex> lk(s_ts_write_lock);
+  std::lock_guard<std::shared_timed_mutex> lk(s_ts_write_lock);
   p.Do(g.slice_length);
   p.Do(g.global_timer);
   p.Do(s_idled_cycles);
@@ -165,7 +482,10 @@ void DoState(PointerWrap& p)
   p.DoMarker("CoreTimingData");
 
   MoveEvents();
-  p.DoEachElement(s_event_queue, [](PointerWrap& pw, Event& ev) {
+  std::vector<Event> events;
+  if (p.GetMode() != PointerWrap::MODE_READ)
+    events = s_event_queue.GetSortedEvents();
+  p.DoEachElement(events, [](PointerWrap& pw, Event& ev) {
     pw.Do(ev.time);
     pw.Do(ev.fifo_order);
 
@@ -198,11 +518,12 @@ void DoState(PointerWrap& p)
   });
   p.DoMarker("CoreTimingEvents");
 
-  // When loading from a save state, we must assume the Event order is random and meaningless.
-  // The exact layout of the heap in memory is implementation defined, therefore it is platform
-  // and library version specific.
   if (p.GetMode() == PointerWrap::MODE_READ)
-    std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+  {
+    s_event_queue.Clear(g.global_timer);
+    for (const Event& ev : events)
+      s_event_queue.Push(ev);
+  }
 }
 
 // This should only be called from the CPU thread. If you are calling
@@ -225,10 +546,11 @@ u64 GetIdleTicks()
 
 void ClearPendingEvents()
 {
-  s_event_queue.clear();
+  s_event_queue.Clear(g.global_timer);
 }
 
-void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata, FromThread from)
+EventHandle ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
+                          FromThread from)
 {
   _assert_msg_(POWERPC, event_type, "Event type is nullptr, will crash now.");
 
@@ -252,8 +574,7 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
     if (!s_is_global_timer_sane)
       ForceExceptionCheck(cycles_into_future);
 
-    s_event_queue.emplace_back(Event{timeout, s_event_fifo_id++, userdata, event_type});
-    std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    return s_event_queue.Push(Event{timeout, s_event_fifo_id++, userdata, event_type});
   }
   else
   {
@@ -264,22 +585,23 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
                 event_type->name->c_str());
     }
 
-    std::lock_guard<std::mutex> lk(s_ts_write_lock);
+    std::shared_lock<std::shared_timed_mutex> lk(s_ts_write_lock);
     s_ts_queue.Push(Event{g.global_timer + cycles_into_future, 0, userdata, event_type});
+    return {};
   }
 }
 
 void RemoveEvent(EventType* event_type)
 {
-  auto itr = std::remove_if(s_event_queue.begin(), s_event_queue.end(),
-                            [&](const Event& e) { return e.type == event_type; });
+  // Callers like PowerPC::Reset may run before their event types are registered, in which case
+  // there can't be any events of that type.
+  if (event_type)
+    s_event_queue.RemoveAll(event_type);
+}
 
-  // Removing random items breaks the invariant so we have to re-establish it.
-  if (itr != s_event_queue.end())
-  {
-    s_event_queue.erase(itr, s_event_queue.end());
-    std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-  }
+void RemoveEvent(EventHandle handle)
+{
+  s_event_queue.Remove(handle);
 }
 
 void RemoveAllEvents(EventType* event_type)
@@ -305,8 +627,7 @@ void MoveEvents()
   for (Event ev; s_ts_queue.Pop(ev);)
   {
     ev.fifo_order = s_event_fifo_id++;
-    s_event_queue.emplace_back(std::move(ev));
-    std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    s_event_queue.Push(ev);
   }
 }
 
@@ -322,11 +643,11 @@ void Advance()
 
   s_is_global_timer_sane = true;
 
-  while (!s_event_queue.empty() && s_event_queue.front().time <= g.global_timer)
+  const Event* next;
+  while ((next = s_event_queue.Peek()) && next->time <= g.global_timer)
   {
-    Event evt = std::move(s_event_queue.front());
-    std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-    s_event_queue.pop_back();
+    const Event evt = *next;
+    s_event_queue.Pop();
     // NOTICE_LOG(POWERPC, "[Scheduler] %-20s (%lld, %lld)", evt.type->name->c_str(),
     //            g.global_timer, evt.time);
     evt.type->callback(evt.userdata, g.global_timer - evt.time);
@@ -335,10 +656,10 @@ void Advance()
   s_is_global_timer_sane = false;
 
   // Still events left (scheduled in the future)
-  if (!s_event_queue.empty())
+  if (next)
   {
-    g.slice_length = static_cast<int>(
-        std::min<s64>(s_event_queue.front().time - g.global_timer, MAX_SLICE_LENGTH));
+    g.slice_length =
+        static_cast<int>(std::min<s64>(next->time - g.global_timer, MAX_SLICE_LENGTH));
   }
 
   PowerPC::ppcState.downcount = CyclesToDowncount(g.slice_length);
@@ -352,9 +673,7 @@ void Advance()
 
 void LogPendingEvents()
 {
-  auto clone = s_event_queue;
-  std::sort(clone.begin(), clone.end());
-  for (const Event& ev : clone)
+  for (const Event& ev : s_event_queue.GetSortedEvents())
   {
     INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %s", g.global_timer,
              ev.time, ev.type->name->c_str());
@@ -364,11 +683,9 @@ void LogPendingEvents()
 // Should only be called from the CPU thread after the PPC clock has changed
 void AdjustEventQueueTimes(u32 new_ppc_clock, u32 old_ppc_clock)
 {
-  for (Event& ev : s_event_queue)
-  {
-    const s64 ticks = (ev.time - g.global_timer) * new_ppc_clock / old_ppc_clock;
-    ev.time = g.global_timer + ticks;
-  }
+  s_event_queue.Retime(g.global_timer, [new_ppc_clock, old_ppc_clock](s64 time) {
+    return g.global_timer + (time - g.global_timer) * new_ppc_clock / old_ppc_clock;
+  });
 }
 
 void Idle()
@@ -385,14 +702,21 @@ void Idle()
   PowerPC::ppcState.downcount = 0;
 }
 
+ThreadSafeQueueStats GetThreadSafeQueueStats()
+{
+  return {s_ts_queue.GetContendedPushCount(), s_ts_queue.GetSpilledPushCount()};
+}
+
 std::string GetScheduledEventsSummary()
 {
   std::string text = "Scheduled events\n";
   text.reserve(1000);
 
-  auto clone = s_event_queue;
-  std::sort(clone.begin(), clone.end());
-  for (const Event& ev : clone)
+  const ThreadSafeQueueStats stats = GetThreadSafeQueueStats();
+  text += StringFromFormat("Off-thread scheduling: %" PRIu64 " contended, %" PRIu64 " spilled\n",
+                           stats.contended_pushes, stats.spilled_pushes);
+
+  for (const Event& ev : s_event_queue.GetSortedEvents())
   {
     text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", ev.type->name->c_str(), ev.time,
                              ev.userdata);
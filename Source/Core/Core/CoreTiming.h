@@ -51,6 +51,14 @@ void DoState(PointerWrap& p);
 
 struct EventType;
 
+// Refers to a single scheduled event. It goes stale once the event has run or was removed,
+// and removing a stale handle does nothing.
+struct EventHandle
+{
+  u32 index = UINT32_MAX;
+  u32 generation = 0;
+};
+
 // Returns the event_type identifier. if name is not unique, an existing event_type will be
 // discarded.
 EventType* RegisterEvent(const std::string& name, TimedCallback callback);
@@ -69,11 +77,13 @@ enum class FromThread
 // After the first Advance, the slice lengths and the downcount will be reduced whenever an event
 // is scheduled earlier than the current values (when scheduled from the CPU Thread only).
 // Scheduling from a callback will not update the downcount until the Advance() completes.
-void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata = 0,
-                   FromThread from = FromThread::CPU);
+// Events scheduled from outside the CPU thread are queued first and get no handle.
+EventHandle ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata = 0,
+                          FromThread from = FromThread::CPU);
 
 // We only permit one event of each type in the queue at a time.
 void RemoveEvent(EventType* event_type);
+void RemoveEvent(EventHandle handle);
 void RemoveAllEvents(EventType* event_type);
 
 // Advance must be called at the beginning of dispatcher loops, not the end. Advance() ends
@@ -95,6 +105,15 @@ void LogPendingEvents();
 
 std::string GetScheduledEventsSummary();
 
+// How often ScheduleEvent calls from other threads got in each other's way, and how often they
+// found the queue to the CPU thread full and had to take the slow path.
+struct ThreadSafeQueueStats
+{
+  u64 contended_pushes;
+  u64 spilled_pushes;
+};
+ThreadSafeQueueStats GetThreadSafeQueueStats();
+
 void AdjustEventQueueTimes(u32 new_ppc_clock, u32 old_ppc_clock);
 
 u32 GetFakeDecStartValue();
@@ -0,0 +1,144 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/HW/DVD/DVDReadAhead.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "DiscIO/BlockCache.h"
+#include "DiscIO/Volume.h"
+
+namespace DVDThread
+{
+ReadAhead::ReadAhead(DiscIO::BlockCache& cache) : m_cache(cache)
+{
+}
+
+ReadAhead::~ReadAhead()
+{
+  Clear();
+}
+
+bool ReadAhead::Read(const DiscIO::Volume& volume, u64 offset, u32 length, u8* buffer,
+                     const DiscIO::Partition& partition)
+{
+  const u64 owner = GetCacheOwner(partition);
+  const u64 first_block = offset / BLOCK_SIZE;
+  const u64 last_block = length != 0 ? (offset + length - 1) / BLOCK_SIZE : first_block;
+
+  // The blocks are held while they're copied out, so evicting them in the meantime is harmless.
+  std::vector<DiscIO::BlockCache::Chunk> blocks;
+  for (u64 block = first_block; length != 0 && block <= last_block; block++)
+  {
+    DiscIO::BlockCache::Chunk chunk = m_cache.Find(owner, block);
+    if (!chunk)
+      break;
+    blocks.push_back(std::move(chunk));
+  }
+
+  bool success = true;
+  if (length == 0 || blocks.size() != last_block - first_block + 1)
+  {
+    m_misses++;
+    success = volume.Read(offset, length, buffer, partition);
+  }
+  else
+  {
+    m_hits++;
+    u8* out = buffer;
+    for (u64 i = 0; i < blocks.size(); i++)
+    {
+      const u64 block_offset = (first_block + i) * BLOCK_SIZE;
+      const u64 start = std::max(offset, block_offset);
+      const u64 end = std::min<u64>(offset + length, block_offset + BLOCK_SIZE);
+      std::memcpy(out, blocks[i]->data() + (start - block_offset), end - start);
+      out += end - start;
+    }
+  }
+
+  UpdateStream(offset, length, partition);
+  return success;
+}
+
+void ReadAhead::UpdateStream(u64 offset, u32 length, const DiscIO::Partition& partition)
+{
+  if (partition == m_stream.partition && offset == m_stream.end)
+  {
+    m_stream.sequential_reads++;
+  }
+  else
+  {
+    m_stream.partition = partition;
+    m_stream.sequential_reads = 0;
+  }
+
+  m_stream.end = offset + length;
+  const u64 stream_block = m_stream.end - m_stream.end % BLOCK_SIZE;
+  if (m_stream.sequential_reads == 0 || m_stream.read_ahead_offset < stream_block)
+    m_stream.read_ahead_offset = stream_block;
+}
+
+bool ReadAhead::IsPending() const
+{
+  return m_stream.sequential_reads >= SEQUENTIAL_READS_BEFORE_READ_AHEAD &&
+         m_stream.read_ahead_offset < m_stream.end + BLOCKS_AHEAD * BLOCK_SIZE;
+}
+
+void ReadAhead::ReadNextBlock(const DiscIO::Volume& volume)
+{
+  const u64 offset = m_stream.read_ahead_offset;
+  m_stream.read_ahead_offset += BLOCK_SIZE;
+  const u64 owner = GetCacheOwner(m_stream.partition);
+  if (m_cache.Contains(owner, offset / BLOCK_SIZE))
+    return;
+
+  std::vector<u8> block(BLOCK_SIZE);
+  if (!volume.Read(offset, BLOCK_SIZE, block.data(), m_stream.partition))
+  {
+    // Most likely the end of the disc or partition. Stop reading ahead of this stream.
+    m_stream.sequential_reads = 0;
+    return;
+  }
+
+  m_cache.Insert(owner, offset / BLOCK_SIZE,
+                 std::make_shared<const std::vector<u8>>(std::move(block)));
+  m_blocks_read_ahead++;
+}
+
+void ReadAhead::Clear()
+{
+  for (const auto& owner : m_cache_owners)
+    m_cache.Erase(owner.second);
+  m_cache_owners.clear();
+  m_stream = {};
+}
+
+ReadAheadStats ReadAhead::GetStats() const
+{
+  return {m_hits.load(), m_misses.load(), m_blocks_read_ahead.load()};
+}
+
+void ReadAhead::ResetStats()
+{
+  m_hits = 0;
+  m_misses = 0;
+  m_blocks_read_ahead = 0;
+}
+
+u64 ReadAhead::GetCacheOwner(const DiscIO::Partition& partition)
+{
+  const auto it = m_cache_owners.find(partition);
+  if (it != m_cache_owners.end())
+    return it->second;
+
+  const u64 owner = DiscIO::BlockCache::NewOwnerID();
+  m_cache_owners.emplace(partition, owner);
+  return owner;
+}
+}
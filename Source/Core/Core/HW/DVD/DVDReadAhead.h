@@ -0,0 +1,76 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <map>
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/DVD/DVDThread.h"
+#include "DiscIO/Volume.h"
+
+namespace DiscIO
+{
+class BlockCache;
+}
+
+namespace DVDThread
+{
+// When the emulated software streams through the disc (FMVs, level loading), the DVD thread
+// reads ahead of the stream while it has nothing else to do, so that the requests which follow
+// don't have to wait for the volume. Blocks which have been read ahead are kept in the shared
+// BlockCache, so they have already been decompressed and decrypted, and they count against the
+// same memory budget as the caches of the volume and the blob reader.
+// Only one thread may use a ReadAhead at a time, except for GetStats.
+class ReadAhead
+{
+public:
+  static constexpr u32 BLOCK_SIZE = 0x10000;
+  // How far ahead of the end of a stream to read
+  static constexpr u32 BLOCKS_AHEAD = 16;
+  static constexpr u32 SEQUENTIAL_READS_BEFORE_READ_AHEAD = 2;
+
+  explicit ReadAhead(DiscIO::BlockCache& cache);
+  ~ReadAhead();
+
+  // Requests which are entirely in the cache are served from it. Anything else is read from
+  // the volume directly, since requests are usually larger than the missing part of a block.
+  // Either way, the request is added to the stream detection.
+  bool Read(const DiscIO::Volume& volume, u64 offset, u32 length, u8* buffer,
+            const DiscIO::Partition& partition);
+
+  // Whether a sequential stream has been detected and the cache isn't far enough ahead of it.
+  bool IsPending() const;
+  // Reads at most one block, so that the DVD thread can get back to new requests quickly.
+  void ReadNextBlock(const DiscIO::Volume& volume);
+
+  // Drops the cached blocks and the stream, for example when the disc changes.
+  void Clear();
+
+  ReadAheadStats GetStats() const;
+  void ResetStats();
+
+private:
+  struct Stream
+  {
+    DiscIO::Partition partition;
+    u64 end = UINT64_MAX;
+    u32 sequential_reads = 0;
+    u64 read_ahead_offset = 0;
+  };
+
+  // Every partition stores its blocks under a cache owner of its own.
+  u64 GetCacheOwner(const DiscIO::Partition& partition);
+  void UpdateStream(u64 offset, u32 length, const DiscIO::Partition& partition);
+
+  DiscIO::BlockCache& m_cache;
+  std::map<DiscIO::Partition, u64> m_cache_owners;
+  Stream m_stream;
+
+  std::atomic<u64> m_hits{0};
+  std::atomic<u64> m_misses{0};
+  std::atomic<u64> m_blocks_read_ahead{0};
+};
+}
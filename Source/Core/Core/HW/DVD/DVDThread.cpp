@@ -27,11 +27,13 @@
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/HW/DVD/DVDInterface.h"
+#include "Core/HW/DVD/DVDReadAhead.h"
 #include "Core/HW/DVD/FileMonitor.h"
 #include "Core/HW/Memmap.h"
 #include "Core/HW/SystemTimers.h"
 #include "Core/IOS/ES/Formats.h"
 
+#include "DiscIO/BlockCache.h"
 #include "DiscIO/Enums.h"
 #include "DiscIO/Volume.h"
 
@@ -89,6 +91,9 @@ static std::map<u64, ReadResult> s_result_map;
 
 static std::unique_ptr<DiscIO::Volume> s_disc;
 
+// Only the DVD thread touches this, except for Start, SetDisc and Stop, which run while it's idle.
+static ReadAhead s_read_ahead(DiscIO::BlockCache::GetShared());
+
 void Start()
 {
   s_finish_read = CoreTiming::RegisterEvent("FinishReadDVDThread", FinishRead);
@@ -102,6 +107,15 @@ void Start()
   // much, because this will never get exposed to the emulated game.
   s_next_id = 0;
 
+  // The stream is reset as well, so that a freshly started (or restarted) DVD thread
+  // never touches the disc before it gets a request.
+  s_read_ahead.Clear();
+  s_read_ahead.ResetStats();
+
+  // Decoded disc data is kept in a cache which all disc readers share.
+  DiscIO::BlockCache::GetShared().SetCapacity(
+      static_cast<size_t>(SConfig::GetInstance().iDiscCacheSize) * 1024 * 1024);
+
   StartDVDThread();
 }
 
@@ -117,6 +131,12 @@ void Stop()
   StopDVDThread();
   s_disc.reset();
   FileMonitor::SetFileSystem(nullptr);
+
+  const ReadAheadStats stats = GetReadAheadStats();
+  INFO_LOG(DVDINTERFACE, "Read-ahead: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64
+                         " blocks read ahead",
+           stats.hits, stats.misses, stats.blocks_read_ahead);
+  s_read_ahead.Clear();
 }
 
 static void StopDVDThread()
@@ -186,6 +206,7 @@ void SetDisc(std::unique_ptr<DiscIO::Volume> disc)
   WaitUntilIdle();
   s_disc = std::move(disc);
   FileMonitor::SetFileSystem(s_disc.get());
+  s_read_ahead.Clear();
 }
 
 bool HasDisc()
@@ -229,6 +250,11 @@ bool UpdateRunningGameMetadata(const DiscIO::Partition& partition, std::optional
   return true;
 }
 
+ReadAheadStats GetReadAheadStats()
+{
+  return s_read_ahead.GetStats();
+}
+
 void WaitUntilIdle()
 {
   _assert_(Core::IsCPUThread());
@@ -348,7 +374,9 @@ static void DVDThread()
 
   while (true)
   {
-    s_request_queue_expanded.Wait();
+    // While reading ahead, only check for new requests between blocks instead of sleeping.
+    if (!s_read_ahead.IsPending())
+      s_request_queue_expanded.Wait();
 
     if (s_dvd_thread_exiting.IsSet())
       return;
@@ -359,8 +387,11 @@ static void DVDThread()
       FileMonitor::Log(request.dvd_offset, request.partition);
 
       std::vector<u8> buffer(request.length);
-      if (!s_disc->Read(request.dvd_offset, request.length, buffer.data(), request.partition))
+      if (!s_read_ahead.Read(*s_disc, request.dvd_offset, request.length, buffer.data(),
+                             request.partition))
+      {
         buffer.resize(0);
+      }
 
       request.realtime_done_us = Common::Timer::GetTimeUs();
 
@@ -370,6 +401,9 @@ static void DVDThread()
       if (s_dvd_thread_exiting.IsSet())
         return;
     }
+
+    if (s_read_ahead.IsPending())
+      s_read_ahead.ReadNextBlock(*s_disc);
   }
 }
 }
@@ -35,12 +35,22 @@ class TicketReader;
 
 namespace DVDThread
 {
+// Counters for tuning the read-ahead of sequential reads. A hit is a request which
+// was served entirely from data that the DVD thread had read ahead.
+struct ReadAheadStats
+{
+  u64 hits;
+  u64 misses;
+  u64 blocks_read_ahead;
+};
+
 void Start();
 void Stop();
 void DoState(PointerWrap& p);
 
 void SetDisc(std::unique_ptr<DiscIO::Volume> disc);
 bool HasDisc();
+ReadAheadStats GetReadAheadStats();
 
 DiscIO::Platform GetDiscType();
 IOS::ES::TMDReader GetTMD(const DiscIO::Partition& partition);
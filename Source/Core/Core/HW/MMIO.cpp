@@ -4,6 +4,7 @@
 
 #include "Core/HW/MMIO.h"
 
+#include <cstdint>
 #include <functional>
 
 #include "Common/Assert.h"
@@ -116,6 +117,33 @@ WriteHandlingMethod<T>* DirectWrite(volatile T* addr, u32 mask)
   return new DirectHandlingMethod<T>((T*)addr, mask);
 }
 
+// Shifted: handling method holds a pointer to a 32 bit counter, and the
+// parameters of the transformation applied to it when it's read.
+template <typename T>
+class ShiftedHandlingMethod : public ReadHandlingMethod<T>
+{
+public:
+  ShiftedHandlingMethod(const u32* addr, u32 addend, u32 shift)
+      : addr_(addr), addend_(addend), shift_(shift)
+  {
+  }
+  virtual ~ShiftedHandlingMethod() = default;
+  void AcceptReadVisitor(ReadHandlingMethodVisitor<T>& v) const override
+  {
+    v.VisitShifted(addr_, addend_, shift_);
+  }
+
+private:
+  const u32* addr_;
+  u32 addend_;
+  u32 shift_;
+};
+template <typename T>
+ReadHandlingMethod<T>* ShiftedRead(const u32* addr, u32 addend, u32 shift)
+{
+  return new ShiftedHandlingMethod<T>(addr, addend, shift);
+}
+
 // Complex: holds a lambda that is called when a read or a write is executed.
 // This gives complete control to the user as to what is going to happen during
 // that read or write, but reduces the optimization potential.
@@ -229,15 +257,66 @@ struct LargerAccessSize<u16>
   typedef u32 value;
 };
 
+// Records which handling method a read handler uses, so that the size
+// converters can combine Constant and Direct handlers into a single handler of
+// the same kind, which the JITs can then inline.
+template <typename T>
+struct ReadMethodInfoVisitor : public ReadHandlingMethodVisitor<T>
+{
+  enum class Kind
+  {
+    Constant,
+    Direct,
+    Other,
+  };
+
+  virtual ~ReadMethodInfoVisitor() = default;
+
+  void VisitConstant(T constant) override
+  {
+    kind = Kind::Constant;
+    value = constant;
+  }
+  void VisitDirect(const T* ptr, u32 direct_mask) override
+  {
+    kind = Kind::Direct;
+    addr = ptr;
+    mask = direct_mask & static_cast<T>(~0);
+  }
+  void VisitShifted(const u32*, u32, u32) override { kind = Kind::Other; }
+  void VisitComplex(const std::function<T(u32)>*) override { kind = Kind::Other; }
+
+  Kind kind = Kind::Other;
+  T value = 0;
+  const T* addr = nullptr;
+  u32 mask = 0;
+};
+
 template <typename T>
 ReadHandlingMethod<T>* ReadToSmaller(Mapping* mmio, u32 high_part_addr, u32 low_part_addr)
 {
   typedef typename SmallerAccessSize<T>::value ST;
+  typedef typename ReadMethodInfoVisitor<ST>::Kind Kind;
 
   ReadHandler<ST>* high_part = &mmio->GetHandlerForRead<ST>(high_part_addr);
   ReadHandler<ST>* low_part = &mmio->GetHandlerForRead<ST>(low_part_addr);
 
-  // TODO(delroth): optimize
+  ReadMethodInfoVisitor<ST> high_info, low_info;
+  high_part->Visit(high_info);
+  low_part->Visit(low_info);
+
+  if (high_info.kind == Kind::Constant && low_info.kind == Kind::Constant)
+    return Constant<T>(((T)high_info.value << (8 * sizeof(ST))) | low_info.value);
+
+  // Two halves of the same variable, e.g. registered with Utils::HighPart/LowPart.
+  if (high_info.kind == Kind::Direct && low_info.kind == Kind::Direct &&
+      high_info.addr == low_info.addr + 1 &&
+      reinterpret_cast<uintptr_t>(low_info.addr) % sizeof(T) == 0)
+  {
+    const u32 mask = (high_info.mask << (8 * sizeof(ST))) | low_info.mask;
+    return DirectRead<T>(reinterpret_cast<const T*>(low_info.addr), mask);
+  }
+
   return ComplexRead<T>([=](u32 addr) {
     return ((T)high_part->Read(high_part_addr) << (8 * sizeof(ST))) | low_part->Read(low_part_addr);
   });
@@ -265,7 +344,16 @@ ReadHandlingMethod<T>* ReadToLarger(Mapping* mmio, u32 larger_addr, u32 shift)
 
   ReadHandler<LT>* large = &mmio->GetHandlerForRead<LT>(larger_addr);
 
-  // TODO(delroth): optimize
+  ReadMethodInfoVisitor<LT> info;
+  large->Visit(info);
+  if (info.kind == ReadMethodInfoVisitor<LT>::Kind::Constant)
+    return Constant<T>(static_cast<T>(info.value >> shift));
+  if (info.kind == ReadMethodInfoVisitor<LT>::Kind::Direct && shift % 8 == 0)
+  {
+    const T* part = reinterpret_cast<const T*>(reinterpret_cast<const u8*>(info.addr) + shift / 8);
+    return DirectRead<T>(part, (info.mask >> shift) & static_cast<T>(~0));
+  }
+
   return ComplexRead<T>(
       [large, shift](u32 addr) { return large->Read(addr & ~(sizeof(LT) - 1)) >> shift; });
 }
@@ -319,6 +407,11 @@ void ReadHandler<T>::ResetMethod(ReadHandlingMethod<T>* method)
       ret = [addr, mask](u32) { return *addr & mask; };
     }
 
+    void VisitShifted(const u32* addr, u32 addend, u32 shift) override
+    {
+      ret = [addr, addend, shift](u32) { return static_cast<T>((*addr + addend) >> shift); };
+    }
+
     void VisitComplex(const std::function<T(u32)>* lambda) override { ret = *lambda; }
   };
 
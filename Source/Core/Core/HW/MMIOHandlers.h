@@ -53,6 +53,13 @@ WriteHandlingMethod<T>* DirectWrite(T* addr, u32 mask = 0xFFFFFFFF);
 template <typename T>
 WriteHandlingMethod<T>* DirectWrite(volatile T* addr, u32 mask = 0xFFFFFFFF);
 
+// Shifted: use when the value read is derived from a 32 bit counter as
+// (counter + addend) >> shift, truncated to the access size. This is only for
+// reads, and allows the JITs to inline registers which would otherwise need a
+// Complex handler (e.g. the VI beam position).
+template <typename T>
+ReadHandlingMethod<T>* ShiftedRead(const u32* addr, u32 addend, u32 shift);
+
 // Complex: use when no other handling method fits your needs. These allow you
 // to directly provide a function that will be called when a read/write needs
 // to be done.
@@ -84,6 +91,9 @@ WriteHandlingMethod<T>* InvalidWrite();
 // u16 handlers for a u32 reads are Direct to consecutive memory addresses,
 // they can be transformed into a Direct u32 access.
 //
+// The underlying handlers are looked up when the combined handler is created,
+// so they have to be registered first.
+//
 // Warning: unlike the other handling methods, *ToSmaller are obviously not
 // available for u8, and *ToLarger are not available for u32.
 template <typename T>
@@ -103,6 +113,7 @@ class ReadHandlingMethodVisitor
 public:
   virtual void VisitConstant(T value) = 0;
   virtual void VisitDirect(const T* addr, u32 mask) = 0;
+  virtual void VisitShifted(const u32* addr, u32 addend, u32 shift) = 0;
   virtual void VisitComplex(const std::function<T(u32)>* lambda) = 0;
 };
 template <typename T>
@@ -208,6 +219,8 @@ private:
   MaybeExtern template ReadHandlingMethod<T>* DirectRead(volatile const T* addr, u32 mask);        \
   MaybeExtern template WriteHandlingMethod<T>* DirectWrite(T* addr, u32 mask);                     \
   MaybeExtern template WriteHandlingMethod<T>* DirectWrite(volatile T* addr, u32 mask);            \
+  MaybeExtern template ReadHandlingMethod<T>* ShiftedRead<T>(const u32* addr, u32 addend,          \
+                                                             u32 shift);                           \
   MaybeExtern template ReadHandlingMethod<T>* ComplexRead<T>(std::function<T(u32)>);               \
   MaybeExtern template WriteHandlingMethod<T>* ComplexWrite<T>(std::function<void(u32, T)>);       \
   MaybeExtern template ReadHandlingMethod<T>* InvalidRead<T>();                                    \
@@ -181,15 +181,20 @@ void Init()
     flags |= PhysicalMemoryRegion::WII_ONLY;
   if (bFakeVMEM)
     flags |= PhysicalMemoryRegion::FAKE_VMEM;
+  // Huge pages can only back a view if its offset in the segment has the same alignment as its
+  // address, so start every region on a huge page boundary. The gaps are never touched.
+  const bool huge_pages = SConfig::GetInstance().bHugePages;
+  const u32 alignment = huge_pages ? static_cast<u32>(MemArena::HUGE_PAGE_SIZE) : 1;
   u32 mem_size = 0;
   for (PhysicalMemoryRegion& region : physical_regions)
   {
     if ((flags & region.flags) != region.flags)
       continue;
+    mem_size = (mem_size + alignment - 1) & ~(alignment - 1);
     region.shm_position = mem_size;
     mem_size += region.size;
   }
-  g_arena.GrabSHMSegment(mem_size);
+  g_arena.GrabSHMSegment(mem_size, huge_pages);
   physical_base = MemArena::FindMemoryBase();
 
   for (PhysicalMemoryRegion& region : physical_regions)
@@ -218,7 +223,8 @@ void Init()
 
   Clear();
 
-  INFO_LOG(MEMMAP, "Memory system initialized. RAM at %p", m_pRAM);
+  INFO_LOG(MEMMAP, "Memory system initialized. RAM at %p%s", m_pRAM,
+           g_arena.UsesHugePages() ? " (huge pages)" : "");
   m_IsInitialized = true;
 }
 
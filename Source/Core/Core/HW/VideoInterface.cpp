@@ -20,6 +20,7 @@
 #include "Core/HW/ProcessorInterface.h"
 #include "Core/HW/SI/SI.h"
 #include "Core/HW/SystemTimers.h"
+#include "Core/State.h"
 
 #include "DiscIO/Enums.h"
 
@@ -312,7 +313,8 @@ void RegisterMMIO(MMIO::Mapping* mmio, u32 base)
   // MMIOs with unimplemented writes that trigger warnings.
   mmio->Register(
       base | VI_VERTICAL_BEAM_POSITION,
-      MMIO::ComplexRead<u16>([](u32) { return 1 + (s_half_line_count - 1) / 2; }),
+      // 1 + (s_half_line_count - 1) / 2, in a form the JITs can inline.
+      MMIO::ShiftedRead<u16>(&s_half_line_count, 1, 1),
       MMIO::ComplexWrite<u16>([](u32, u16 val) {
         WARN_LOG(VIDEOINTERFACE,
                  "Changing vertical beam position to 0x%04x - not documented or implemented yet",
@@ -716,6 +718,7 @@ static void BeginField(FieldType field, u64 ticks)
 static void EndField()
 {
   Core::VideoThrottle();
+  State::RewindFrameUpdate();
 }
 
 // Purpose: Send VI interrupt when triggered
@@ -149,6 +149,7 @@ const std::string hotkey_labels[] = {
     _trans("Save Oldest State"),
     _trans("Undo Load State"),
     _trans("Undo Save State"),
+    _trans("Rewind"),
     _trans("Save State"),
     _trans("Load State"),
 };
@@ -4,6 +4,7 @@
 
 #include "Core/PowerPC/CachedInterpreter/CachedInterpreter.h"
 
+#include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Core/ConfigManager.h"
@@ -19,6 +20,8 @@ struct CachedInterpreter::Instruction
 {
   typedef void (*CommonCallback)(UGeckoInstruction);
   typedef bool (*ConditionalCallback)(u32 data);
+  // Gets the operands in the form they were decoded to when the block was compiled.
+  typedef void (*PredecodedCallback)(u32 imm, u8 d, u8 a, u8 b);
 
   Instruction() : type(INSTRUCTION_ABORT) {}
   Instruction(const CommonCallback c, UGeckoInstruction i)
@@ -31,17 +34,29 @@ struct CachedInterpreter::Instruction
   {
   }
 
+  Instruction(const PredecodedCallback c, u32 imm, u8 d, u8 a, u8 b)
+      : predecoded_callback(c), data(imm), reg_d(d), reg_a(a), reg_b(b),
+        type(INSTRUCTION_TYPE_PREDECODED)
+  {
+  }
+
   union
   {
     const CommonCallback common_callback;
     const ConditionalCallback conditional_callback;
+    const PredecodedCallback predecoded_callback;
   };
   u32 data;
-  enum
+  // Register numbers (or a shift amount) of predecoded instructions.
+  u8 reg_d = 0;
+  u8 reg_a = 0;
+  u8 reg_b = 0;
+  enum Type : u8
   {
     INSTRUCTION_ABORT,
     INSTRUCTION_TYPE_COMMON,
     INSTRUCTION_TYPE_CONDITIONAL,
+    INSTRUCTION_TYPE_PREDECODED,
   } type;
 };
 
@@ -86,24 +101,51 @@ void CachedInterpreter::ExecuteOneBlock()
 
   const Instruction* code = reinterpret_cast<const Instruction*>(normal_entry);
 
-  for (; code->type != Instruction::INSTRUCTION_ABORT; ++code)
-  {
-    switch (code->type)
-    {
-    case Instruction::INSTRUCTION_TYPE_COMMON:
-      code->common_callback(UGeckoInstruction(code->data));
-      break;
+#ifdef __GNUC__
+  // With computed gotos every instruction type gets its own indirect jump, which the host's
+  // branch predictor handles much better than the single jump of a switch.
+  static const void* const dispatch_table[] = {&&abort, &&common, &&conditional, &&predecoded};
+#define DISPATCH() goto* dispatch_table[code->type]
+#else
+#define DISPATCH() goto dispatch
+#endif
 
-    case Instruction::INSTRUCTION_TYPE_CONDITIONAL:
-      if (code->conditional_callback(code->data))
-        return;
-      break;
+  DISPATCH();
 
-    default:
-      ERROR_LOG(POWERPC, "Unknown CachedInterpreter Instruction: %d", code->type);
-      break;
-    }
+common:
+  code->common_callback(UGeckoInstruction(code->data));
+  ++code;
+  DISPATCH();
+
+conditional:
+  if (code->conditional_callback(code->data))
+    return;
+  ++code;
+  DISPATCH();
+
+predecoded:
+  code->predecoded_callback(code->data, code->reg_d, code->reg_a, code->reg_b);
+  ++code;
+  DISPATCH();
+
+abort:
+  return;
+
+#ifndef __GNUC__
+dispatch:
+  switch (code->type)
+  {
+  case Instruction::INSTRUCTION_TYPE_COMMON:
+    goto common;
+  case Instruction::INSTRUCTION_TYPE_CONDITIONAL:
+    goto conditional;
+  case Instruction::INSTRUCTION_TYPE_PREDECODED:
+    goto predecoded;
+  default:
+    goto abort;
   }
+#endif
+#undef DISPATCH
 }
 
 void CachedInterpreter::Run()
@@ -169,6 +211,88 @@ static bool CheckDSI(u32 data)
   return false;
 }
 
+// Specialized versions of common integer instructions. These only cover the forms which don't
+// update CR0 or XER, so they never need to look at the instruction again.
+
+// addi rD, 0, SIMM and addis rD, 0, SIMM
+static void LoadImmediate(u32 imm, u8 d, u8 a, u8 b)
+{
+  rGPR[d] = imm;
+}
+
+// addi rD, rA, SIMM and addis rD, rA, SIMM
+static void AddImmediate(u32 imm, u8 d, u8 a, u8 b)
+{
+  rGPR[d] = rGPR[a] + imm;
+}
+
+// ori rA, rS, UIMM and oris rA, rS, UIMM
+static void OrImmediate(u32 imm, u8 d, u8 a, u8 b)
+{
+  rGPR[d] = rGPR[a] | imm;
+}
+
+// or rA, rS, rS (mr)
+static void MoveRegister(u32 imm, u8 d, u8 a, u8 b)
+{
+  rGPR[d] = rGPR[a];
+}
+
+// or rA, rS, rB
+static void OrRegister(u32 imm, u8 d, u8 a, u8 b)
+{
+  rGPR[d] = rGPR[a] | rGPR[b];
+}
+
+// rlwinm rA, rS, SH, MB, ME, with the mask precomputed
+static void RotateAndMask(u32 mask, u8 d, u8 a, u8 sh)
+{
+  rGPR[d] = _rotl(rGPR[a], sh) & mask;
+}
+
+void CachedInterpreter::WriteInterpreterOp(UGeckoInstruction inst)
+{
+  switch (inst.OPCD)
+  {
+  case 14:  // addi
+  case 15:  // addis
+  {
+    const u32 imm = inst.OPCD == 14 ? inst.SIMM_16 : inst.SIMM_16 << 16;
+    if (inst.RA)
+      m_code.push_back(Instruction(AddImmediate, imm, inst.RD, inst.RA, 0));
+    else
+      m_code.push_back(Instruction(LoadImmediate, imm, inst.RD, 0, 0));
+    return;
+  }
+
+  case 24:  // ori
+  case 25:  // oris
+  {
+    const u32 imm = inst.OPCD == 24 ? inst.UIMM : inst.UIMM << 16;
+    m_code.push_back(Instruction(OrImmediate, imm, inst.RA, inst.RS, 0));
+    return;
+  }
+
+  case 21:  // rlwinmx
+    if (inst.Rc)
+      break;
+    m_code.push_back(
+        Instruction(RotateAndMask, Helper_Mask(inst.MB, inst.ME), inst.RA, inst.RS, inst.SH));
+    return;
+
+  case 31:
+    if (inst.SUBOP10 != 444 || inst.Rc)  // orx
+      break;
+    if (inst.RS == inst.RB)
+      m_code.push_back(Instruction(MoveRegister, 0, inst.RA, inst.RS, 0));
+    else
+      m_code.push_back(Instruction(OrRegister, 0, inst.RA, inst.RS, inst.RB));
+    return;
+  }
+
+  m_code.emplace_back(GetInterpreterOp(inst), inst);
+}
+
 void CachedInterpreter::Jit(u32 address)
 {
   if (m_code.size() >= CODE_SIZE / sizeof(Instruction) - 0x1000 ||
@@ -242,7 +366,7 @@ void CachedInterpreter::Jit(u32 address)
 
       if (endblock || memcheck)
         m_code.emplace_back(WritePC, ops[i].address);
-      m_code.emplace_back(GetInterpreterOp(ops[i].inst), ops[i].inst);
+      WriteInterpreterOp(ops[i].inst);
       if (memcheck)
         m_code.emplace_back(CheckDSI, js.downcountAmount);
       if (endblock)
@@ -36,6 +36,7 @@ private:
 
   const u8* GetCodePtr() const;
   void ExecuteOneBlock();
+  void WriteInterpreterOp(UGeckoInstruction inst);
 
   BlockCache m_block_cache{*this};
   std::vector<Instruction> m_code;
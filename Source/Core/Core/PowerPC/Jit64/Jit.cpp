@@ -230,6 +230,9 @@ void Jit64::Init()
   AddChildCodeSpace(&trampolines, trampolines_size);
   AddChildCodeSpace(&m_far_code, farcode_size);
   m_const_pool.Init(AllocChildCodeSpace(constpool_size), constpool_size);
+  SetSegmentCount(NUM_CODE_SEGMENTS);
+  trampolines.SetSegmentCount(NUM_CODE_SEGMENTS);
+  m_far_code.SetSegmentCount(NUM_CODE_SEGMENTS);
 
   // BLR optimization has the same consequences as block linking, as well as
   // depending on the fault handler to be safe in the event of excessive BL.
@@ -241,6 +244,14 @@ void Jit64::Init()
   if (m_enable_blr_optimization)
     AllocStack();
 
+  m_use_block_list = SConfig::GetInstance().bJITPersistentBlockList &&
+                     !SConfig::GetInstance().bJITNoBlockCache &&
+                     !SConfig::GetInstance().bEnableDebugging;
+  m_block_list_loaded = false;
+
+  m_profile_guided_recompile = SConfig::GetInstance().bJITProfileGuidedRecompile &&
+                               !SConfig::GetInstance().bEnableDebugging;
+
   blocks.Init();
   asm_routines.Init(m_stack ? (m_stack + STACK_SIZE) : nullptr);
 
@@ -267,8 +278,37 @@ void Jit64::ClearCache()
   UpdateMemoryOptions();
 }
 
+bool Jit64::IsCodeSegmentAlmostFull() const
+{
+  return IsAlmostFull() || m_far_code.IsAlmostFull() || trampolines.IsAlmostFull();
+}
+
+void Jit64::ClearOldestCodeSegment()
+{
+  // Blocks only ever use far code and trampolines of their own segment or of a newer one,
+  // so the blocks of the reused near code segment are the only ones which have to go.
+  // Constants stay in the pool, as the remaining blocks may still refer to them.
+  const size_t segment = (GetCurrentSegment() + 1) % NUM_CODE_SEGMENTS;
+  const u8* start = GetSegmentStart(segment);
+  const u8* end = start + GetSegmentSize();
+  blocks.EraseHostCodeRange(start, end);
+  ClearRange(start, end);
+
+  // Loads and stores in far code (slow paths, exception exits) have backpatching
+  // information of their own, which would otherwise match code emitted there later.
+  const u8* far_start = m_far_code.GetSegmentStart(segment);
+  ClearRange(far_start, far_start + m_far_code.GetSegmentSize());
+
+  ClearSegment(segment);
+  m_far_code.ClearSegment(segment);
+  trampolines.ClearSegment(segment);
+}
+
 void Jit64::Shutdown()
 {
+  if (m_block_list_loaded)
+    blocks.SaveBlockList(JitBaseBlockCache::GetBlockListFileName());
+
   FreeStack();
   FreeCodeSpace();
 
@@ -348,6 +388,11 @@ static void ImHere()
   been_here[PC] = 1;
 }
 
+static void RequestBlockRecompile(JitBlock* block)
+{
+  g_jit->GetBlockCache()->RequestRecompile(*block);
+}
+
 bool Jit64::Cleanup()
 {
   bool did_something = false;
@@ -498,6 +543,16 @@ void Jit64::WriteExceptionExit()
   JMP(asm_routines.dispatcher, true);
 }
 
+// Used for loops which can't make progress until the next event.
+void Jit64::WriteIdleExit(u32 destination)
+{
+  ABI_PushRegistersAndAdjustStack({}, 0);
+  ABI_CallFunction(CoreTiming::Idle);
+  ABI_PopRegistersAndAdjustStack({}, 0);
+  MOV(32, PPCSTATE(pc), Imm32(destination));
+  WriteExceptionExit();
+}
+
 void Jit64::WriteExternalExceptionExit()
 {
   Cleanup();
@@ -558,11 +613,10 @@ void Jit64::Jit(u32 em_address)
 #endif
   }
 
-  if (IsAlmostFull() || m_far_code.IsAlmostFull() || trampolines.IsAlmostFull() ||
-      SConfig::GetInstance().bJITNoBlockCache)
-  {
+  if (SConfig::GetInstance().bJITNoBlockCache)
     ClearCache();
-  }
+  else if (IsCodeSegmentAlmostFull())
+    ClearOldestCodeSegment();
 
   int blockSize = code_buffer.GetSize();
 
@@ -586,16 +640,30 @@ void Jit64::Jit(u32 em_address)
         analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
         analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
         analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+        analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_TRACE_FOLLOW);
       }
       Trace();
     }
   }
 
+  // Hot blocks which requested their recompilation stay in the cache until the optimized
+  // version is ready, as other blocks may still be linked to them.
+  const bool baseline = m_profile_guided_recompile && !blocks.GetBlockToRecompile(em_address, MSR);
+
+  if (baseline)
+  {
+    analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+    analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_TRACE_FOLLOW);
+  }
+
   // Analyze the block, collect all instructions it is made of (including inlining,
   // if that is enabled), reorder instructions for optimal performance, and join joinable
   // instructions.
   u32 nextPC = analyzer.Analyze(em_address, &code_block, &code_buffer, blockSize);
 
+  if (baseline)
+    EnableOptimization();
+
   if (code_block.m_memory_exception)
   {
     // Address of instruction could not be translated
@@ -607,8 +675,46 @@ void Jit64::Jit(u32 em_address)
   }
 
   JitBlock* b = blocks.AllocateBlock(em_address);
+  b->hot_countdown = baseline ? HOT_BLOCK_THRESHOLD : 0;
   DoJit(em_address, &code_buffer, b, nextPC);
+  // Looked up again, since the old block may have been erased while this one was compiled.
+  if (m_profile_guided_recompile && !baseline)
+  {
+    if (JitBlock* hot_block = blocks.GetBlockToRecompile(em_address, MSR))
+      blocks.EraseBlock(*hot_block);
+  }
   blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+
+  if (m_use_block_list)
+  {
+    if (!m_block_list_loaded)
+    {
+      const std::string filename = JitBaseBlockCache::GetBlockListFileName();
+      if (!filename.empty())
+        blocks.LoadBlockList(filename);
+      m_block_list_loaded = !filename.empty();
+    }
+    CompileListedBlocks(b->physicalAddress);
+  }
+}
+
+void Jit64::CompileListedBlocks(u32 physical_address)
+{
+  const u32 msr_bits = MSR & JitBaseBlockCache::JIT_CACHE_MSR_MASK;
+  for (u32 em_address : blocks.TakeListedBlocks(physical_address, msr_bits))
+  {
+    // Don't throw blocks away just to compile blocks which haven't been requested yet.
+    if (IsCodeSegmentAlmostFull())
+      return;
+
+    u32 nextPC = analyzer.Analyze(em_address, &code_block, &code_buffer, code_buffer.GetSize());
+    if (code_block.m_memory_exception)
+      continue;
+
+    JitBlock* b = blocks.AllocateBlock(em_address);
+    DoJit(em_address, &code_buffer, b, nextPC);
+    blocks.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+  }
 }
 
 const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBlock* b, u32 nextPC)
@@ -658,6 +764,23 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
     // get start tic
     PROFILER_QUERY_PERFORMANCE_COUNTER(&b->ticStart);
   }
+
+  // Baseline blocks go back to the dispatcher once they are hot, which then finds no block
+  // and asks for the optimized version.
+  if (b->hot_countdown != 0)
+  {
+    MOV(64, R(RSCRATCH), ImmPtr(&b->hot_countdown));
+    SUB(32, MatR(RSCRATCH), Imm8(1));
+    FixupBranch hot = J_CC(CC_Z, true);
+    SwitchToFarCode();
+    SetJumpTarget(hot);
+    ABI_PushRegistersAndAdjustStack({}, 0);
+    ABI_CallFunctionP(RequestBlockRecompile, b);
+    ABI_PopRegistersAndAdjustStack({}, 0);
+    MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
+    JMP(asm_routines.dispatcherNoCheck, true);
+    SwitchToNearCode();
+  }
 #if defined(_DEBUG) || defined(DEBUGFAST) || defined(NAN_CHECK)
   // should help logged stack-traces become more accurate
   MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
@@ -993,6 +1116,11 @@ void Jit64::EnableOptimization()
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_FOLLOW);
+
+  // The interpreter fallback for branches can't leave a block on a followed branch.
+  const SConfig& config = SConfig::GetInstance();
+  if (config.bJITTraceFormation && !config.bJITOff && !config.bJITBranchOff)
+    analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_TRACE_FOLLOW);
 }
 
 void Jit64::IntializeSpeculativeConstants()
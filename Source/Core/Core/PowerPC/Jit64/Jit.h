@@ -72,6 +72,7 @@ public:
   void WriteExitDestInRSCRATCH(bool bl = false, u32 after = 0);
   void WriteBLRExit();
   void WriteExceptionExit();
+  void WriteIdleExit(u32 destination);
   void WriteExternalExceptionExit();
   void WriteRfiExitDestInRSCRATCH();
   bool Cleanup();
@@ -102,6 +103,10 @@ public:
   // Generates a branch that will check if a given bit of a CR register part
   // is set or not.
   Gen::FixupBranch JumpIfCRFieldBit(int field, int bit, bool jump_if_set = true);
+  // Generates a branch which is taken unless the data BATs map the page containing
+  // reg_addr + offset to RAM, which can then be accessed through RMEM without any
+  // fallback. Only valid with MSR.DR set. Clobbers RSCRATCH and RSCRATCH_EXTRA.
+  Gen::FixupBranch JumpIfNotBATMappedRAM(Gen::X64Reg reg_addr, s32 offset);
   void SetFPRFIfNeeded(Gen::X64Reg xmm);
 
   void HandleNaNs(UGeckoInstruction inst, Gen::X64Reg xmm_out, Gen::X64Reg xmm_in,
@@ -237,6 +242,17 @@ private:
   void AllocStack();
   void FreeStack();
 
+  // Compiles the blocks of the persistent block list which start in the same
+  // page as the given physical address.
+  void CompileListedBlocks(u32 physical_address);
+
+  // The near code, far code and trampoline spaces are used as rings of NUM_CODE_SEGMENTS
+  // segments each, which are switched together. Once one of them runs out of space, only the
+  // blocks in the oldest segment are thrown away instead of the whole cache.
+  static constexpr size_t NUM_CODE_SEGMENTS = 4;
+  bool IsCodeSegmentAlmostFull() const;
+  void ClearOldestCodeSegment();
+
   GPRRegCache gpr{*this};
   FPURegCache fpr{*this};
 
@@ -248,4 +264,14 @@ private:
   bool m_enable_blr_optimization;
   bool m_cleanup_after_stackfault;
   u8* m_stack;
+
+  // The block list is loaded on the first compile, as the game isn't known yet at Init().
+  bool m_use_block_list = false;
+  bool m_block_list_loaded = false;
+
+  // With profile-guided recompilation, blocks are first compiled without the optimizations
+  // which make the code larger (branch following and trace formation), and count their
+  // executions. After HOT_BLOCK_THRESHOLD executions, they are compiled again with them.
+  static constexpr u32 HOT_BLOCK_THRESHOLD = 1000;
+  bool m_profile_guided_recompile = false;
 };
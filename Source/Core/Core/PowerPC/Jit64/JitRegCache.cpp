@@ -70,6 +70,13 @@ void RegCache::DiscardRegContentsIfCached(size_t preg)
   }
 }
 
+void RegCache::DiscardRegister(size_t preg)
+{
+  DiscardRegContentsIfCached(preg);
+  m_regs[preg].away = false;
+  m_regs[preg].location = GetDefaultLocation(preg);
+}
+
 void RegCache::SetEmitter(XEmitter* emitter)
 {
   m_emitter = emitter;
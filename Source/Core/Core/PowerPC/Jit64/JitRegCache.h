@@ -48,6 +48,9 @@ public:
   void Start();
 
   void DiscardRegContentsIfCached(size_t preg);
+  // Forgets the value of a register without storing it, for when the JIT overwrites
+  // the register in memory directly.
+  void DiscardRegister(size_t preg);
   void SetEmitter(Gen::XEmitter* emitter);
 
   void Flush(FlushMode mode = FlushMode::All, BitSet32 regsToFlush = BitSet32::AllTrue(32));
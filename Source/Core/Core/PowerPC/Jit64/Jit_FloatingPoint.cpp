@@ -111,6 +111,8 @@ void Jit64::HandleNaNs(UGeckoInstruction inst, X64Reg xmm_out, X64Reg xmm, X64Re
     MOVDDUP(xmm, MConst(psGeneratedQNaN));
     for (FixupBranch fixup : fixups)
       SetJumpTarget(fixup);
+    // An input SNaN comes out quieted, as it does on the PowerPC.
+    ORPD(xmm, MConst(psGeneratedQNaN));
     FixupBranch done = J(true);
     SwitchToNearCode();
     SetJumpTarget(done);
@@ -223,9 +225,11 @@ void Jit64::fp_arith(UGeckoInstruction inst)
   default:
     _assert_msg_(DYNA_REC, 0, "fp_arith WTF!!!");
   }
-  HandleNaNs(inst, fpr.RX(d), dest);
+  HandleNaNs(inst, dest, dest);
   if (single)
-    ForceSinglePrecision(fpr.RX(d), fpr.R(d), packed, true);
+    ForceSinglePrecision(fpr.RX(d), R(dest), packed, true);
+  else if (dest != fpr.RX(d))
+    MOVAPD(fpr.RX(d), R(dest));
   SetFPRFIfNeeded(fpr.RX(d));
   fpr.UnlockAll();
 }
@@ -245,8 +249,18 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
   bool packed = inst.OPCD == 4 || (!cpu_info.bAtom && single && js.op->fprIsDuplicated[a] &&
                                    js.op->fprIsDuplicated[b] && js.op->fprIsDuplicated[c]);
 
+  // While we don't know if any games are actually affected (replays seem to work with all the usual
+  // suspects for desyncing), netplay and other applications need absolute perfect determinism, so
+  // be extra careful and don't use FMA, even if in theory it might be okay.
+  // Note that FMA isn't necessarily less correct (it may actually be closer to correct) compared
+  // to what the Gekko does here; in deterministic mode, the important thing is multiple Dolphin
+  // instances on different computers giving identical results.
+  const bool use_fma = cpu_info.bFMA && !Core::WantsDeterminism();
+
   fpr.Lock(a, b, c, d);
 
+  // The multiplicand. Without FMA, the multiplication can read c directly unless it needs rounding.
+  OpArg c_arg = R(XMM1);
   switch (inst.SUBOP5)
   {
   case 14:
@@ -260,23 +274,20 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
       Force25BitPrecision(XMM1, R(XMM1), XMM0);
     break;
   default:
-    bool special = inst.SUBOP5 == 30 && (!cpu_info.bFMA || Core::WantsDeterminism());
+    bool special = inst.SUBOP5 == 30 && !use_fma;
     X64Reg tmp1 = special ? XMM0 : XMM1;
     X64Reg tmp2 = special ? XMM1 : XMM0;
+    c_arg = R(tmp1);
     if (single && round_input)
       Force25BitPrecision(tmp1, fpr.R(c), tmp2);
-    else
+    else if (use_fma)
       MOVAPD(tmp1, fpr.R(c));
+    else
+      c_arg = fpr.R(c);
     break;
   }
 
-  // While we don't know if any games are actually affected (replays seem to work with all the usual
-  // suspects for desyncing), netplay and other applications need absolute perfect determinism, so
-  // be extra careful and don't use FMA, even if in theory it might be okay.
-  // Note that FMA isn't necessarily less correct (it may actually be closer to correct) compared
-  // to what the Gekko does here; in deterministic mode, the important thing is multiple Dolphin
-  // instances on different computers giving identical results.
-  if (cpu_info.bFMA && !Core::WantsDeterminism())
+  if (use_fma)
   {
     // Statistics suggests b is a lot less likely to be unbound in practice, so
     // if we have to pick one of a or b to bind, let's make it b.
@@ -318,24 +329,23 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
   else if (inst.SUBOP5 == 30)  // nmsub
   {
     // We implement nmsub a little differently ((b - a*c) instead of -(a*c - b)), so handle it
-    // separately.
-    MOVAPD(XMM1, fpr.R(b));
+    // separately. With AVX, the three-operand forms save copying c and b into scratch registers.
     if (packed)
     {
-      MULPD(XMM0, fpr.R(a));
-      SUBPD(XMM1, R(XMM0));
+      avx_op(&XEmitter::VMULPD, &XEmitter::MULPD, XMM0, c_arg, fpr.R(a), true, true);
+      avx_op(&XEmitter::VSUBPD, &XEmitter::SUBPD, XMM1, fpr.R(b), R(XMM0), true);
     }
     else
     {
-      MULSD(XMM0, fpr.R(a));
-      SUBSD(XMM1, R(XMM0));
+      avx_op(&XEmitter::VMULSD, &XEmitter::MULSD, XMM0, c_arg, fpr.R(a), false, true);
+      avx_op(&XEmitter::VSUBSD, &XEmitter::SUBSD, XMM1, fpr.R(b), R(XMM0), false);
     }
   }
   else
   {
     if (packed)
     {
-      MULPD(XMM1, fpr.R(a));
+      avx_op(&XEmitter::VMULPD, &XEmitter::MULPD, XMM1, c_arg, fpr.R(a), true, true);
       if (inst.SUBOP5 == 28)  // msub
         SUBPD(XMM1, fpr.R(b));
       else  //(n)madd(s[01])
@@ -343,7 +353,7 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
     }
     else
     {
-      MULSD(XMM1, fpr.R(a));
+      avx_op(&XEmitter::VMULSD, &XEmitter::MULSD, XMM1, c_arg, fpr.R(a), false, true);
       if (inst.SUBOP5 == 28)
         SUBSD(XMM1, fpr.R(b));
       else
@@ -355,8 +365,8 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
   fpr.BindToRegister(d, !single);
   if (single)
   {
-    HandleNaNs(inst, fpr.RX(d), XMM1);
-    ForceSinglePrecision(fpr.RX(d), fpr.R(d), packed, true);
+    HandleNaNs(inst, XMM1, XMM1);
+    ForceSinglePrecision(fpr.RX(d), R(XMM1), packed, true);
   }
   else
   {
@@ -425,6 +435,16 @@ void Jit64::fselx(UGeckoInstruction inst)
   else
     CMPSD(XMM0, fpr.R(a), CMP_NLE);
 
+  if (packed && cpu_info.bAVX)
+  {
+    // With VEX, ps_sel can blend straight into the destination.
+    fpr.BindToRegister(c, true, false);
+    fpr.BindToRegister(d, d == b || d == c);
+    VBLENDVPD(fpr.RX(d), fpr.RX(c), fpr.R(b), XMM0);
+    fpr.UnlockAll();
+    return;
+  }
+
   if (cpu_info.bSSE4_1)
   {
     MOVAPD(XMM1, fpr.R(c));
@@ -370,7 +370,10 @@ void Jit64::DoMergedBranch()
       destination = SignExt16(next.BD << 2);
     else
       destination = nextPC + SignExt16(next.BD << 2);
-    WriteExit(destination, next.LK, nextPC + 4);
+    if (js.op[1].branchIsIdleLoop)
+      WriteIdleExit(destination);
+    else
+      WriteExit(destination, next.LK, nextPC + 4);
   }
   else if ((next.OPCD == 19) && (next.SUBOP10 == 528))  // bcctrx
   {
@@ -416,6 +419,18 @@ void Jit64::DoMergedBranchCondition()
   else  // SO bit, do not branch (we don't emulate SO for cmp).
     pDontBranch = J(true);
 
+  // With trace formation, the block continues at the branch target.
+  if (js.op[1].branchIsFollowed)
+  {
+    FixupBranch pBranch = J(true);
+    SetJumpTarget(pDontBranch);
+    gpr.Flush(RegCache::FlushMode::MaintainState);
+    fpr.Flush(RegCache::FlushMode::MaintainState);
+    WriteExit(nextPC + 4);
+    SetJumpTarget(pBranch);
+    return;
+  }
+
   gpr.Flush(RegCache::FlushMode::MaintainState);
   fpr.Flush(RegCache::FlushMode::MaintainState);
 
@@ -452,6 +467,18 @@ void Jit64::DoMergedBranchImmediate(s64 val)
   else  // SO bit, do not branch (we don't emulate SO for cmp).
     branch = false;
 
+  // With trace formation, the block continues at the branch target.
+  if (js.op[1].branchIsFollowed)
+  {
+    if (!branch)
+    {
+      gpr.Flush();
+      fpr.Flush();
+      WriteExit(nextPC + 4);
+    }
+    return;
+  }
+
   if (branch)
   {
     gpr.Flush();
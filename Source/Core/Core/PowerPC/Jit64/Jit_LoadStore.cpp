@@ -9,8 +9,10 @@
 
 #include "Common/Assert.h"
 #include "Common/BitSet.h"
+#include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
 #include "Common/MsgHandler.h"
+#include "Common/Swap.h"
 #include "Common/x64ABI.h"
 #include "Common/x64Emitter.h"
 
@@ -20,6 +22,7 @@
 #include "Core/HW/Memmap.h"
 #include "Core/PowerPC/Jit64/JitRegCache.h"
 #include "Core/PowerPC/Jit64Common/Jit64PowerPCState.h"
+#include "Core/PowerPC/JitCommon/JitAsmCommon.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
 
@@ -528,23 +531,70 @@ void Jit64::stXx(UGeckoInstruction inst)
   gpr.UnlockAllX();
 }
 
+FixupBranch Jit64::JumpIfNotBATMappedRAM(X64Reg reg_addr, s32 offset)
+{
+  MOV(64, R(RSCRATCH_EXTRA), ImmPtr(&PowerPC::dbat_table[0]));
+  LEA(32, RSCRATCH, MDisp(reg_addr, offset));
+  SHR(32, R(RSCRATCH), Imm8(PowerPC::BAT_INDEX_SHIFT));
+  TEST(32, MComplex(RSCRATCH_EXTRA, RSCRATCH, SCALE_4, 0), Imm32(PowerPC::BAT_PHYSICAL_BIT));
+  return J_CC(CC_Z, true);
+}
+
 // A few games use these heavily in video codecs.
 void Jit64::lmw(UGeckoInstruction inst)
 {
   INSTRUCTION_START
   JITDISABLE(bJITLoadStoreOff);
 
+  const s32 size = (32 - inst.RD) * 4;
+
   // TODO: This doesn't handle rollback on DSI correctly
   MOV(32, R(RSCRATCH2), Imm32((u32)(s32)inst.SIMM_16));
   if (inst.RA)
     ADD(32, R(RSCRATCH2), gpr.R(inst.RA));
+
+  // Both paths below write the loaded values to ppcState directly.
+  for (int i = inst.RD; i < 32; i++)
+    gpr.DiscardRegister(i);
+
+  FixupBranch done;
+  if (UReg_MSR(MSR).DR)
+  {
+    // If the whole range is in RAM, a single check replaces the fallbacks of every access.
+    gpr.FlushLockX(RSCRATCH_EXTRA);
+    FixupBranch slow_first = JumpIfNotBATMappedRAM(RSCRATCH2, 0);
+    FixupBranch slow_last = JumpIfNotBATMappedRAM(RSCRATCH2, size - 1);
+
+    int i = inst.RD;
+    if (cpu_info.bSSSE3)
+    {
+      for (; i + 4 <= 32; i += 4)
+      {
+        MOVDQU(XMM0, MComplex(RMEM, RSCRATCH2, SCALE_1, (i - inst.RD) * 4));
+        PSHUFB(XMM0, MConst(pbswapShuffle4x4));
+        MOVDQU(PPCSTATE(gpr[i]), XMM0);
+      }
+    }
+    for (; i < 32; i++)
+    {
+      LoadAndSwap(32, RSCRATCH, MComplex(RMEM, RSCRATCH2, SCALE_1, (i - inst.RD) * 4));
+      MOV(32, PPCSTATE(gpr[i]), R(RSCRATCH));
+    }
+    done = J(true);
+
+    SetJumpTarget(slow_first);
+    SetJumpTarget(slow_last);
+  }
+
   for (int i = inst.RD; i < 32; i++)
   {
     SafeLoadToReg(RSCRATCH, R(RSCRATCH2), 32, (i - inst.RD) * 4,
                   CallerSavedRegistersInUse() | BitSet32{RSCRATCH2}, false);
-    gpr.BindToRegister(i, false, true);
-    MOV(32, gpr.R(i), R(RSCRATCH));
+    MOV(32, PPCSTATE(gpr[i]), R(RSCRATCH));
   }
+
+  if (UReg_MSR(MSR).DR)
+    SetJumpTarget(done);
   gpr.UnlockAllX();
 }
 
@@ -553,6 +603,55 @@ void Jit64::stmw(UGeckoInstruction inst)
   INSTRUCTION_START
   JITDISABLE(bJITLoadStoreOff);
 
+  const s32 size = (32 - inst.RD) * 4;
+
+  FixupBranch done;
+  if (UReg_MSR(MSR).DR)
+  {
+    // If the whole range is in RAM, a single check replaces the fallbacks of every access.
+    gpr.FlushLockX(RSCRATCH_EXTRA);
+    MOV(32, R(RSCRATCH2), Imm32((u32)(s32)inst.SIMM_16));
+    if (inst.RA)
+      ADD(32, R(RSCRATCH2), gpr.R(inst.RA));
+    FixupBranch slow_first = JumpIfNotBATMappedRAM(RSCRATCH2, 0);
+    FixupBranch slow_last = JumpIfNotBATMappedRAM(RSCRATCH2, size - 1);
+
+    const auto in_memory = [this](int reg) {
+      return !gpr.R(reg).IsImm() && !gpr.R(reg).IsSimpleReg();
+    };
+
+    int i = inst.RD;
+    while (i < 32)
+    {
+      const OpArg dest = MComplex(RMEM, RSCRATCH2, SCALE_1, (i - inst.RD) * 4);
+      // Registers which aren't cached are stored four at a time.
+      if (cpu_info.bSSSE3 && i + 4 <= 32 && in_memory(i) && in_memory(i + 1) &&
+          in_memory(i + 2) && in_memory(i + 3))
+      {
+        MOVDQU(XMM0, PPCSTATE(gpr[i]));
+        PSHUFB(XMM0, MConst(pbswapShuffle4x4));
+        MOVDQU(dest, XMM0);
+        i += 4;
+        continue;
+      }
+
+      if (gpr.R(i).IsImm())
+      {
+        MOV(32, dest, Imm32(Common::swap32(gpr.R(i).Imm32())));
+      }
+      else
+      {
+        MOV(32, R(RSCRATCH), gpr.R(i));
+        SwapAndStore(32, dest, RSCRATCH);
+      }
+      i++;
+    }
+    done = J(true);
+
+    SetJumpTarget(slow_first);
+    SetJumpTarget(slow_last);
+  }
+
   // TODO: This doesn't handle rollback on DSI correctly
   for (int i = inst.RD; i < 32; i++)
   {
@@ -572,6 +671,9 @@ void Jit64::stmw(UGeckoInstruction inst)
                         CallerSavedRegistersInUse());
     }
   }
+
+  if (UReg_MSR(MSR).DR)
+    SetJumpTarget(done);
   gpr.UnlockAllX();
 }
 
@@ -242,6 +242,10 @@ public:
   {
     LoadAddrMaskToReg(8 * sizeof(T), addr, mask);
   }
+  void VisitShifted(const u32* addr, u32 addend, u32 shift) override
+  {
+    LoadShiftedToReg(8 * sizeof(T), addr, addend, shift);
+  }
   void VisitComplex(const std::function<T(u32)>* lambda) override
   {
     CallLambda(8 * sizeof(T), lambda);
@@ -291,6 +295,18 @@ private:
     }
   }
 
+  void LoadShiftedToReg(int sbits, const u32* ptr, u32 addend, u32 shift)
+  {
+    m_code->MOV(64, R(RSCRATCH), ImmPtr(ptr));
+    m_code->MOV(32, R(m_dst_reg), MatR(RSCRATCH));
+    if (addend != 0)
+      m_code->ADD(32, R(m_dst_reg), Imm32(addend));
+    if (shift != 0)
+      m_code->SHR(32, R(m_dst_reg), Imm8(shift));
+    if (sbits < 32)
+      MoveOpArgToReg(sbits, R(m_dst_reg));
+  }
+
   void CallLambda(int sbits, const std::function<T(u32)>* lambda)
   {
     m_code->ABI_PushRegistersAndAdjustStack(m_registers_in_use, 0);
@@ -1146,3 +1162,19 @@ void EmuCodeBlock::Clear()
   m_back_patch_info.clear();
   m_exception_handler_at_loc.clear();
 }
+
+void EmuCodeBlock::ClearRange(const u8* start, const u8* end)
+{
+  const auto erase_range = [start, end](auto& map) {
+    for (auto it = map.begin(); it != map.end();)
+    {
+      if (it->first >= start && it->first < end)
+        it = map.erase(it);
+      else
+        ++it;
+    }
+  };
+
+  erase_range(m_back_patch_info);
+  erase_range(m_exception_handler_at_loc);
+}
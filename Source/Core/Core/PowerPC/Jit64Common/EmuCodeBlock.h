@@ -122,6 +122,8 @@ public:
   void ConvertDoubleToSingle(Gen::X64Reg dst, Gen::X64Reg src);
   void SetFPRF(Gen::X64Reg xmm);
   void Clear();
+  // Drops the backpatching information of the code in [start, end).
+  void ClearRange(const u8* start, const u8* end);
 
 protected:
   ConstantPool m_const_pool;
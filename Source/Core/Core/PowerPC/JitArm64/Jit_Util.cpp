@@ -105,6 +105,10 @@ public:
   {
     LoadAddrMaskToReg(8 * sizeof(T), addr, mask);
   }
+  virtual void VisitShifted(const u32* addr, u32 addend, u32 shift)
+  {
+    LoadShiftedToReg(8 * sizeof(T), addr, addend, shift);
+  }
   virtual void VisitComplex(const std::function<T(u32)>* lambda)
   {
     CallLambda(8 * sizeof(T), lambda);
@@ -164,6 +168,21 @@ private:
     }
   }
 
+  void LoadShiftedToReg(int sbits, const u32* ptr, u32 addend, u32 shift)
+  {
+    m_emit->MOVP2R(X0, ptr);
+    m_emit->LDR(INDEX_UNSIGNED, m_dst_reg, X0, 0);
+    if (addend != 0)
+      m_emit->ADDI2R(m_dst_reg, m_dst_reg, addend, W0);
+    if (shift != 0)
+      m_emit->LSR(m_dst_reg, m_dst_reg, shift);
+
+    if (m_sign_extend)
+      m_emit->SBFM(m_dst_reg, m_dst_reg, 0, sbits - 1);
+    else if (sbits < 32)
+      m_emit->UBFM(m_dst_reg, m_dst_reg, 0, sbits - 1);
+  }
+
   void CallLambda(int sbits, const std::function<T(u32)>* lambda)
   {
     ARM64FloatEmitter float_emit(m_emit);
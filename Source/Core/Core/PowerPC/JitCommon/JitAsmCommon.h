@@ -8,6 +8,7 @@
 
 alignas(16) extern const u8 pbswapShuffle1x4[16];
 alignas(16) extern const u8 pbswapShuffle2x4[16];
+alignas(16) extern const u8 pbswapShuffle4x4[16];
 alignas(16) extern const float m_one[4];
 alignas(16) extern const float m_quantizeTableS[128];
 alignas(16) extern const float m_dequantizeTableS[128];
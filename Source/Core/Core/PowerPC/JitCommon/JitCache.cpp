@@ -15,12 +15,21 @@
 #include <functional>
 #include <map>
 #include <set>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include <xxhash.h>
+
+#include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
 #include "Common/JitRegister.h"
+#include "Common/Logging/Log.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/HW/Memmap.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -31,12 +40,165 @@
 
 using namespace Gen;
 
+namespace
+{
+constexpr u32 BLOCK_LIST_MAGIC = 0x4C4B4C42;  // "BLKL"
+// Increment this when the layout of the block list changes.
+constexpr u32 BLOCK_LIST_VERSION = 1;
+
+struct BlockListHeader
+{
+  u32 magic;
+  u32 version;
+  u32 num_blocks;
+};
+
+// Each entry is followed by num_instructions physical addresses.
+struct BlockListEntry
+{
+  u32 effective_address;
+  u32 msr_bits;
+  u32 physical_address;
+  u32 num_instructions;
+  u64 guest_hash;
+};
+
+// No block has more instructions than fit into the code buffer of the JITs.
+constexpr u32 MAX_LISTED_BLOCK_INSTRUCTIONS = 32000;
+}  // Anonymous namespace
+
+static bool IsRAMAddress(u32 physical_address)
+{
+  physical_address &= 0x3FFFFFFF;
+  if (physical_address < Memory::REALRAM_SIZE)
+    return true;
+
+  return Memory::m_pEXRAM && (physical_address >> 28) == 0x1 &&
+         (physical_address & 0x0FFFFFFF) < Memory::EXRAM_SIZE;
+}
+
+// Hashes the guest instructions occupied by a block. This fails for blocks with
+// code outside of RAM (e.g. the locked L1 cache), which are never listed.
+template <typename Container>
+static bool HashGuestCode(const Container& physical_addresses, u64* hash)
+{
+  std::vector<u32> code;
+  code.reserve(physical_addresses.size());
+  for (u32 address : physical_addresses)
+  {
+    if (!IsRAMAddress(address))
+      return false;
+    code.push_back(Memory::Read_U32(address));
+  }
+
+  *hash = XXH64(code.data(), code.size() * sizeof(u32), 0);
+  return true;
+}
+
 bool JitBlock::OverlapsPhysicalRange(u32 address, u32 length) const
 {
   return physical_addresses.lower_bound(address) !=
          physical_addresses.lower_bound(address + length);
 }
 
+void BlockRangeMap::Clear()
+{
+  m_slots.clear();
+  m_slots.resize(size_t(1) << INITIAL_SLOT_BITS);
+  m_slot_bits = INITIAL_SLOT_BITS;
+  m_size = 0;
+}
+
+std::vector<JitBlock*>& BlockRangeMap::operator[](u32 key)
+{
+  // Keep the load factor below 1/2 so that probe sequences stay short.
+  if ((m_size + 1) * 2 > m_slots.size())
+    Grow();
+
+  const size_t mask = m_slots.size() - 1;
+  size_t i = SlotIndex(key);
+  while (m_slots[i].key != EMPTY_KEY)
+  {
+    if (m_slots[i].key == key)
+      return m_slots[i].blocks;
+    i = (i + 1) & mask;
+  }
+
+  m_slots[i].key = key;
+  ++m_size;
+  return m_slots[i].blocks;
+}
+
+std::vector<JitBlock*>* BlockRangeMap::Find(u32 key)
+{
+  const size_t mask = m_slots.size() - 1;
+  for (size_t i = SlotIndex(key); m_slots[i].key != EMPTY_KEY; i = (i + 1) & mask)
+  {
+    if (m_slots[i].key == key)
+      return &m_slots[i].blocks;
+  }
+  return nullptr;
+}
+
+void BlockRangeMap::Erase(u32 key)
+{
+  const size_t mask = m_slots.size() - 1;
+  size_t i = SlotIndex(key);
+  while (m_slots[i].key != key)
+  {
+    if (m_slots[i].key == EMPTY_KEY)
+      return;
+    i = (i + 1) & mask;
+  }
+  m_slots[i].blocks.clear();
+
+  // Move the following entries of the probe sequence back into the hole, so that
+  // lookups don't stop early at an empty slot.
+  for (size_t j = (i + 1) & mask; m_slots[j].key != EMPTY_KEY; j = (j + 1) & mask)
+  {
+    const size_t home = SlotIndex(m_slots[j].key);
+    const bool home_in_range = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+    if (home_in_range)
+      continue;
+
+    m_slots[i].key = m_slots[j].key;
+    std::swap(m_slots[i].blocks, m_slots[j].blocks);
+    i = j;
+  }
+
+  m_slots[i].key = EMPTY_KEY;
+  --m_size;
+}
+
+void BlockRangeMap::CollectKeys(u32 first, u32 last, std::vector<u32>* keys) const
+{
+  for (const Slot& slot : m_slots)
+  {
+    if (slot.key != EMPTY_KEY && slot.key >= first && slot.key <= last)
+      keys->push_back(slot.key);
+  }
+}
+
+void BlockRangeMap::Grow()
+{
+  std::vector<Slot> old_slots(m_slots.size() * 2);
+  std::swap(old_slots, m_slots);
+  ++m_slot_bits;
+
+  const size_t mask = m_slots.size() - 1;
+  for (Slot& slot : old_slots)
+  {
+    if (slot.key == EMPTY_KEY)
+      continue;
+
+    size_t i = SlotIndex(slot.key);
+    while (m_slots[i].key != EMPTY_KEY)
+      i = (i + 1) & mask;
+    m_slots[i].key = slot.key;
+    m_slots[i].blocks = std::move(slot.blocks);
+  }
+}
+
 JitBaseBlockCache::JitBaseBlockCache(JitBase& jit) : m_jit{jit}
 {
 }
@@ -64,13 +226,13 @@ void JitBaseBlockCache::Clear()
 #endif
   m_jit.js.fifoWriteAddresses.clear();
   m_jit.js.pairedQuantizeAddresses.clear();
-  for (auto& e : block_map)
-  {
-    DestroyBlock(e.second);
-  }
-  block_map.clear();
-  links_to.clear();
-  block_range_map.clear();
+  block_map.ForEach([this](JitBlock& block) {
+    DestroyBlock(block);
+    FreeBlock(&block);
+  });
+  block_map.Clear();
+  links_to.Clear();
+  block_range_map.Clear();
 
   valid_block.ClearAll();
 
@@ -90,19 +252,21 @@ JitBlock** JitBaseBlockCache::GetFastBlockMap()
 
 void JitBaseBlockCache::RunOnBlocks(std::function<void(const JitBlock&)> f)
 {
-  for (const auto& e : block_map)
-    f(e.second);
+  block_map.ForEach([&f](const JitBlock& block) { f(block); });
 }
 
 JitBlock* JitBaseBlockCache::AllocateBlock(u32 em_address)
 {
   u32 physicalAddress = PowerPC::JitCache_TranslateAddress(em_address).address;
-  JitBlock& b = block_map.emplace(physicalAddress, JitBlock())->second;
+  JitBlock& b = *NewBlock();
   b.effectiveAddress = em_address;
   b.physicalAddress = physicalAddress;
   b.msrBits = MSR & JIT_CACHE_MSR_MASK;
   b.linkData.clear();
   b.fast_block_map_index = 0;
+  b.hot_countdown = 0;
+  b.recompile_requested = false;
+  block_map.Insert(&b);
   return &b;
 }
 
@@ -119,14 +283,20 @@ void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
   for (u32 addr : physical_addresses)
   {
     valid_block.Set(addr / 32);
-    block_range_map[addr & range_mask].insert(&block);
+
+    // The addresses are sorted, so the block is already in the list if it was
+    // added for a previous address of the same macro block.
+    std::vector<JitBlock*>& range_blocks = block_range_map[addr & range_mask];
+    if (range_blocks.empty() || range_blocks.back() != &block)
+      range_blocks.push_back(&block);
   }
 
   if (block_link)
   {
-    for (const auto& e : block.linkData)
+    for (auto& e : block.linkData)
     {
-      links_to.emplace(e.exitAddress, &block);
+      e.block = &block;
+      links_to.Insert(&e);
     }
 
     LinkBlock(block);
@@ -141,6 +311,16 @@ void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
 }
 
 JitBlock* JitBaseBlockCache::GetBlockFromStartAddress(u32 addr, u32 msr)
+{
+  return FindBlock(addr, msr, false);
+}
+
+JitBlock* JitBaseBlockCache::GetBlockToRecompile(u32 addr, u32 msr)
+{
+  return FindBlock(addr, msr, true);
+}
+
+JitBlock* JitBaseBlockCache::FindBlock(u32 addr, u32 msr, bool recompile_requested)
 {
   u32 translated_addr = addr;
   if (UReg_MSR(msr).IR)
@@ -153,15 +333,10 @@ JitBlock* JitBaseBlockCache::GetBlockFromStartAddress(u32 addr, u32 msr)
     translated_addr = translated.address;
   }
 
-  auto iter = block_map.equal_range(translated_addr);
-  for (; iter.first != iter.second; iter.first++)
-  {
-    JitBlock& b = iter.first->second;
-    if (b.effectiveAddress == addr && b.msrBits == (msr & JIT_CACHE_MSR_MASK))
-      return &b;
-  }
-
-  return nullptr;
+  return block_map.Find(translated_addr, [addr, msr, recompile_requested](const JitBlock& b) {
+    return b.effectiveAddress == addr && b.msrBits == (msr & JIT_CACHE_MSR_MASK) &&
+           b.recompile_requested == recompile_requested;
+  });
 }
 
 const u8* JitBaseBlockCache::Dispatch()
@@ -216,58 +391,256 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
 
 void JitBaseBlockCache::ErasePhysicalRange(u32 address, u32 length)
 {
-  // Iterate over all macro blocks which overlap the given range.
-  u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
-  auto start = block_range_map.lower_bound(address & range_mask);
-  auto end = block_range_map.lower_bound(address + length);
-  while (start != end)
-  {
+  if (length == 0)
+    return;
+
+  const u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
+  const u32 first = address & range_mask;
+  const u32 last =
+      static_cast<u32>(std::min<u64>(u64(address) + length - 1, 0xFFFFFFFF)) & range_mask;
+
+  const auto erase_macro_block = [&](u32 key) {
+    std::vector<JitBlock*>* blocks = block_range_map.Find(key);
+    if (!blocks)
+      return;
+
     // Iterate over all blocks in the macro block.
-    auto iter = start->second.begin();
-    while (iter != start->second.end())
+    size_t i = 0;
+    while (i < blocks->size())
     {
-      JitBlock* block = *iter;
-      if (block->OverlapsPhysicalRange(address, length))
-      {
-        // If the block overlaps, also remove all other occupied slots in the other macro blocks.
-        // This will leak empty macro blocks, but they may be reused or cleared later on.
-        for (u32 addr : block->physical_addresses)
-          if ((addr & range_mask) != start->first)
-            block_range_map[addr & range_mask].erase(block);
-
-        // And remove the block.
-        DestroyBlock(*block);
-        auto block_map_iter = block_map.equal_range(block->physicalAddress);
-        while (block_map_iter.first != block_map_iter.second)
-        {
-          if (&block_map_iter.first->second == block)
-          {
-            block_map.erase(block_map_iter.first);
-            break;
-          }
-          block_map_iter.first++;
-        }
-        iter = start->second.erase(iter);
-      }
-      else
+      JitBlock* block = (*blocks)[i];
+      if (!block->OverlapsPhysicalRange(address, length))
       {
-        iter++;
+        i++;
+        continue;
       }
+
+      // This also removes the block from the current macro block.
+      EraseBlock(*block);
     }
 
     // If the macro block is empty, drop it.
-    if (start->second.empty())
-      start = block_range_map.erase(start);
-    else
-      start++;
+    if (blocks->empty())
+      block_range_map.Erase(key);
+  };
+
+  // Iterate over all macro blocks which overlap the given range. For huge ranges,
+  // it's cheaper to look at the existing macro blocks than at every possible one.
+  const u32 num_macro_blocks = (last - first) / BLOCK_RANGE_MAP_ELEMENTS + 1;
+  if (num_macro_blocks > block_range_map.Capacity())
+  {
+    std::vector<u32> keys;
+    block_range_map.CollectKeys(first, last, &keys);
+    for (u32 key : keys)
+      erase_macro_block(key);
+  }
+  else
+  {
+    for (u32 i = 0; i < num_macro_blocks; i++)
+      erase_macro_block(first + i * BLOCK_RANGE_MAP_ELEMENTS);
   }
 }
 
+void JitBaseBlockCache::RequestRecompile(JitBlock& block)
+{
+  block.recompile_requested = true;
+  if (fast_block_map[block.fast_block_map_index] == &block)
+    fast_block_map[block.fast_block_map_index] = nullptr;
+}
+
+void JitBaseBlockCache::EraseBlock(JitBlock& block)
+{
+  // Remove the block from all macro blocks it occupies. This will leak empty macro blocks,
+  // but they may be reused or cleared later on. The addresses are sorted, so each macro
+  // block only has to be visited once.
+  const u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
+  u32 previous_key = 0xFFFFFFFF;
+  for (u32 addr : block.physical_addresses)
+  {
+    const u32 key = addr & range_mask;
+    if (key == previous_key)
+      continue;
+    previous_key = key;
+
+    if (std::vector<JitBlock*>* range_blocks = block_range_map.Find(key))
+    {
+      auto it = std::find(range_blocks->begin(), range_blocks->end(), &block);
+      if (it != range_blocks->end())
+      {
+        *it = range_blocks->back();
+        range_blocks->pop_back();
+      }
+    }
+  }
+
+  DestroyBlock(block);
+  block_map.Erase(&block);
+  FreeBlock(&block);
+}
+
+void JitBaseBlockCache::EraseHostCodeRange(const u8* start, const u8* end)
+{
+  std::vector<JitBlock*> erased_blocks;
+  block_map.ForEach([&](JitBlock& block) {
+    if (block.checkedEntry >= start && block.checkedEntry < end)
+      erased_blocks.push_back(&block);
+  });
+
+  for (JitBlock* block : erased_blocks)
+    EraseBlock(*block);
+}
+
 u32* JitBaseBlockCache::GetBlockBitSet() const
 {
   return valid_block.m_valid_block.get();
 }
 
+std::string JitBaseBlockCache::GetBlockListFileName()
+{
+  const std::string& game_id = SConfig::GetInstance().GetGameID();
+  if (game_id.empty())
+    return "";
+
+  return File::GetUserPath(D_CACHE_IDX) + "JIT" DIR_SEP + game_id + ".blocks";
+}
+
+void JitBaseBlockCache::SaveBlockList(const std::string& filename)
+{
+  std::vector<BlockListEntry> entries;
+  std::vector<std::vector<u32>> addresses;
+
+  block_map.ForEach([&](const JitBlock& block) {
+    u64 hash;
+    if (!HashGuestCode(block.physical_addresses, &hash))
+      return;
+
+    entries.push_back({block.effectiveAddress, block.msrBits, block.physicalAddress,
+                       static_cast<u32>(block.physical_addresses.size()), hash});
+    addresses.emplace_back(block.physical_addresses.begin(), block.physical_addresses.end());
+  });
+
+  // Keep the listed blocks which weren't reached during this session,
+  // so that the list doesn't shrink every time a game is booted.
+  for (const auto& page : listed_blocks)
+  {
+    for (const ListedBlock& block : page.second)
+    {
+      entries.push_back({block.effective_address, block.msr_bits, block.physical_address,
+                         static_cast<u32>(block.physical_addresses.size()), block.guest_hash});
+      addresses.push_back(block.physical_addresses);
+    }
+  }
+
+  if (entries.empty())
+    return;
+
+  File::CreateFullPath(filename);
+  File::IOFile file(filename, "wb");
+  const BlockListHeader header{BLOCK_LIST_MAGIC, BLOCK_LIST_VERSION,
+                               static_cast<u32>(entries.size())};
+  bool success = file.WriteArray(&header, 1);
+  for (size_t i = 0; success && i < entries.size(); ++i)
+  {
+    success = file.WriteArray(&entries[i], 1) &&
+              file.WriteArray(addresses[i].data(), addresses[i].size());
+  }
+
+  if (!success)
+  {
+    ERROR_LOG(DYNA_REC, "Failed to write JIT block list %s", filename.c_str());
+    file.Close();
+    File::Delete(filename);
+    return;
+  }
+
+  INFO_LOG(DYNA_REC, "Wrote %zu blocks to JIT block list %s", entries.size(), filename.c_str());
+}
+
+void JitBaseBlockCache::LoadBlockList(const std::string& filename)
+{
+  listed_blocks.clear();
+
+  File::IOFile file(filename, "rb");
+  if (!file)
+    return;
+
+  BlockListHeader header;
+  if (!file.ReadArray(&header, 1) || header.magic != BLOCK_LIST_MAGIC ||
+      header.version != BLOCK_LIST_VERSION)
+  {
+    WARN_LOG(DYNA_REC, "Ignoring outdated JIT block list %s", filename.c_str());
+    return;
+  }
+
+  // Each block takes up at least its entry and one address, so a corrupted count can't make
+  // this read past what the file holds.
+  const u64 max_blocks =
+      (file.GetSize() - sizeof(header)) / (sizeof(BlockListEntry) + sizeof(u32));
+  if (header.num_blocks > max_blocks)
+  {
+    WARN_LOG(DYNA_REC, "Ignoring corrupted JIT block list %s", filename.c_str());
+    return;
+  }
+
+  for (u32 i = 0; i < header.num_blocks; ++i)
+  {
+    BlockListEntry entry;
+    ListedBlock block;
+    if (file.ReadArray(&entry, 1) && entry.num_instructions != 0 &&
+        entry.num_instructions <= MAX_LISTED_BLOCK_INSTRUCTIONS)
+    {
+      block.physical_addresses.resize(entry.num_instructions);
+      if (file.ReadArray(block.physical_addresses.data(), block.physical_addresses.size()))
+      {
+        block.effective_address = entry.effective_address;
+        block.msr_bits = entry.msr_bits;
+        block.physical_address = entry.physical_address;
+        block.guest_hash = entry.guest_hash;
+        listed_blocks[block.physical_address >> BLOCK_LIST_PAGE_SHIFT].push_back(std::move(block));
+        continue;
+      }
+    }
+
+    WARN_LOG(DYNA_REC, "Ignoring corrupted JIT block list %s", filename.c_str());
+    listed_blocks.clear();
+    return;
+  }
+
+  INFO_LOG(DYNA_REC, "Loaded %u blocks from JIT block list %s", header.num_blocks,
+           filename.c_str());
+}
+
+std::vector<u32> JitBaseBlockCache::TakeListedBlocks(u32 physical_address, u32 msr)
+{
+  std::vector<u32> result;
+
+  auto page = listed_blocks.find(physical_address >> BLOCK_LIST_PAGE_SHIFT);
+  if (page == listed_blocks.end())
+    return result;
+
+  std::vector<ListedBlock>& blocks = page->second;
+  auto end = std::remove_if(blocks.begin(), blocks.end(), [&](const ListedBlock& block) {
+    if (block.msr_bits != msr)
+      return false;
+
+    auto translated = PowerPC::JitCache_TranslateAddress(block.effective_address);
+    u64 hash;
+    if (translated.valid && translated.address == block.physical_address &&
+        HashGuestCode(block.physical_addresses, &hash) && hash == block.guest_hash &&
+        !GetBlockFromStartAddress(block.effective_address, msr))
+    {
+      result.push_back(block.effective_address);
+    }
+    return true;
+  });
+  blocks.erase(end, blocks.end());
+
+  if (blocks.empty())
+    listed_blocks.erase(page);
+
+  return result;
+}
+
 void JitBaseBlockCache::WriteDestroyBlock(const JitBlock& block)
 {
 }
@@ -297,14 +670,12 @@ void JitBaseBlockCache::LinkBlockExits(JitBlock& block)
 void JitBaseBlockCache::LinkBlock(JitBlock& block)
 {
   LinkBlockExits(block);
-  auto ppp = links_to.equal_range(block.effectiveAddress);
 
-  for (auto iter = ppp.first; iter != ppp.second; ++iter)
-  {
-    JitBlock& b2 = *iter->second;
+  links_to.ForEachWithKey(block.effectiveAddress, [this, &block](JitBlock::LinkData& e) {
+    JitBlock& b2 = *e.block;
     if (block.msrBits == b2.msrBits)
       LinkBlockExits(b2);
-  }
+  });
 }
 
 void JitBaseBlockCache::UnlinkBlock(const JitBlock& block)
@@ -316,22 +687,13 @@ void JitBaseBlockCache::UnlinkBlock(const JitBlock& block)
   }
 
   // Unlink all exits of other blocks which points to this block
-  auto ppp = links_to.equal_range(block.effectiveAddress);
-  for (auto iter = ppp.first; iter != ppp.second; ++iter)
-  {
-    JitBlock& sourceBlock = *iter->second;
-    if (sourceBlock.msrBits != block.msrBits)
-      continue;
+  links_to.ForEachWithKey(block.effectiveAddress, [this, &block](JitBlock::LinkData& e) {
+    if (e.block->msrBits != block.msrBits)
+      return;
 
-    for (auto& e : sourceBlock.linkData)
-    {
-      if (e.exitAddress == block.effectiveAddress)
-      {
-        WriteLinkBlock(e, nullptr);
-        e.linkStatus = false;
-      }
-    }
-  }
+    WriteLinkBlock(e, nullptr);
+    e.linkStatus = false;
+  });
 }
 
 void JitBaseBlockCache::DestroyBlock(JitBlock& block)
@@ -342,22 +704,35 @@ void JitBaseBlockCache::DestroyBlock(JitBlock& block)
   UnlinkBlock(block);
 
   // Delete linking addresses
-  for (const auto& e : block.linkData)
-  {
-    auto it = links_to.equal_range(e.exitAddress);
-    while (it.first != it.second)
-    {
-      if (it.first->second == &block)
-        it.first = links_to.erase(it.first);
-      else
-        it.first++;
-    }
-  }
+  for (auto& e : block.linkData)
+    links_to.Erase(&e);
 
   // Raise an signal if we are going to call this block again
   WriteDestroyBlock(block);
 }
 
+JitBlock* JitBaseBlockCache::NewBlock()
+{
+  if (free_blocks.empty())
+  {
+    block_slabs.emplace_back(new JitBlock[BLOCK_SLAB_SIZE]);
+    JitBlock* slab = block_slabs.back().get();
+    for (size_t i = BLOCK_SLAB_SIZE; i > 0; i--)
+      free_blocks.push_back(&slab[i - 1]);
+  }
+
+  JitBlock* block = free_blocks.back();
+  free_blocks.pop_back();
+  return block;
+}
+
+void JitBaseBlockCache::FreeBlock(JitBlock* block)
+{
+  block->linkData.clear();
+  block->physical_addresses.clear();
+  free_blocks.push_back(block);
+}
+
 JitBlock* JitBaseBlockCache::MoveBlockIntoFastCache(u32 addr, u32 msr)
 {
   JitBlock* block = GetBlockFromStartAddress(addr, msr);
@@ -11,6 +11,8 @@
 #include <map>
 #include <memory>
 #include <set>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -59,6 +61,10 @@ struct JitBlock
     u32 exitAddress;
     bool linkStatus;  // is it already linked?
     bool call;
+
+    // Set by the block cache when the exit is added to links_to.
+    JitBlock* block;
+    LinkData* next_link;  // next exit in the same links_to bucket
   };
   std::vector<LinkData> linkData;
 
@@ -74,6 +80,16 @@ struct JitBlock
   // This tracks the position if this block within the fast block cache.
   // We allow each block to have only one map entry.
   size_t fast_block_map_index;
+
+  // Next block in the same block_map bucket.
+  JitBlock* next_block;
+
+  // Blocks compiled with the cheap baseline settings count down their executions here,
+  // and request to be recompiled once this reaches zero. 0 if the block doesn't count.
+  u32 hot_countdown;
+  // Set once the block requested its recompilation. The dispatcher doesn't find such
+  // blocks anymore, but linked blocks keep using them until they are replaced.
+  bool recompile_requested;
 };
 
 typedef void (*CompiledCode)();
@@ -108,6 +124,151 @@ public:
   bool Test(u32 bit) { return (m_valid_block[bit / 32] & (1u << (bit % 32))) != 0; }
 };
 
+// A hash table of u32 keys which chains its entries through a pointer member of
+// the entries themselves, so that inserting and erasing never allocates. Entries
+// must not move while they are in the table.
+template <typename T, u32 T::*Key, T* T::*Next>
+class IntrusiveHashTable final
+{
+public:
+  IntrusiveHashTable() { Clear(); }
+
+  void Clear()
+  {
+    m_buckets.assign(size_t(1) << INITIAL_BUCKET_BITS, nullptr);
+    m_bucket_bits = INITIAL_BUCKET_BITS;
+    m_size = 0;
+  }
+
+  void Insert(T* entry)
+  {
+    if (m_size >= m_buckets.size())
+      Rehash(m_bucket_bits + 1);
+
+    T*& head = m_buckets[BucketIndex(entry->*Key)];
+    entry->*Next = head;
+    head = entry;
+    ++m_size;
+  }
+
+  void Erase(T* entry)
+  {
+    for (T** iter = &m_buckets[BucketIndex(entry->*Key)]; *iter; iter = &((*iter)->*Next))
+    {
+      if (*iter == entry)
+      {
+        *iter = entry->*Next;
+        --m_size;
+        return;
+      }
+    }
+  }
+
+  // Returns the first entry with the given key for which pred returns true.
+  template <typename Pred>
+  T* Find(u32 key, Pred pred) const
+  {
+    for (T* entry = m_buckets[BucketIndex(key)]; entry; entry = entry->*Next)
+    {
+      if (entry->*Key == key && pred(*entry))
+        return entry;
+    }
+    return nullptr;
+  }
+
+  // Calls f for every entry with the given key. f must not insert or erase entries.
+  template <typename F>
+  void ForEachWithKey(u32 key, F f) const
+  {
+    for (T* entry = m_buckets[BucketIndex(key)]; entry; entry = entry->*Next)
+    {
+      if (entry->*Key == key)
+        f(*entry);
+    }
+  }
+
+  // Calls f for every entry. f may reuse the entry it's given, but nothing else.
+  template <typename F>
+  void ForEach(F f) const
+  {
+    for (T* head : m_buckets)
+    {
+      for (T* entry = head; entry;)
+      {
+        T* next = entry->*Next;
+        f(*entry);
+        entry = next;
+      }
+    }
+  }
+
+private:
+  static constexpr u32 INITIAL_BUCKET_BITS = 12;
+
+  size_t BucketIndex(u32 key) const { return (key * 0x9E3779B1u) >> (32 - m_bucket_bits); }
+  void Rehash(u32 bucket_bits)
+  {
+    std::vector<T*> old_buckets(size_t(1) << bucket_bits, nullptr);
+    std::swap(old_buckets, m_buckets);
+    m_bucket_bits = bucket_bits;
+    for (T* head : old_buckets)
+    {
+      for (T* entry = head; entry;)
+      {
+        T* next = entry->*Next;
+        T*& new_head = m_buckets[BucketIndex(entry->*Key)];
+        entry->*Next = new_head;
+        new_head = entry;
+        entry = next;
+      }
+    }
+  }
+
+  std::vector<T*> m_buckets;
+  u32 m_bucket_bits;
+  size_t m_size;
+};
+
+// An open-addressed map from macro block addresses to the blocks overlapping
+// them. Slots are never freed, so the block vectors keep their capacity when a
+// macro block is emptied and reused.
+class BlockRangeMap final
+{
+public:
+  BlockRangeMap() { Clear(); }
+
+  void Clear();
+
+  // Returns the blocks of a macro block, creating an empty list if necessary.
+  std::vector<JitBlock*>& operator[](u32 key);
+  // Returns nullptr if there is no entry for the given macro block.
+  std::vector<JitBlock*>* Find(u32 key);
+  // Erasing moves other entries around, so this invalidates the result of Find().
+  void Erase(u32 key);
+
+  // Appends the keys of all entries in [first, last] to keys.
+  void CollectKeys(u32 first, u32 last, std::vector<u32>* keys) const;
+  size_t Capacity() const { return m_slots.size(); }
+
+private:
+  // Macro block addresses are aligned, so this can never be a valid key.
+  static constexpr u32 EMPTY_KEY = 0xFFFFFFFF;
+  static constexpr u32 INITIAL_SLOT_BITS = 12;
+
+  struct Slot
+  {
+    u32 key = EMPTY_KEY;
+    std::vector<JitBlock*> blocks;
+  };
+
+  size_t SlotIndex(u32 key) const { return (key * 0x9E3779B1u) >> (32 - m_slot_bits); }
+  void Grow();
+
+  std::vector<Slot> m_slots;
+  u32 m_slot_bits;
+  size_t m_size;
+};
+
 class JitBaseBlockCache
 {
 public:
@@ -147,8 +308,31 @@ public:
   void InvalidateICache(u32 address, u32 length, bool forced);
   void ErasePhysicalRange(u32 address, u32 length);
 
+  // Profile-guided recompilation.
+  // Hides the block from the dispatcher, so that the JIT gets asked for a new version.
+  void RequestRecompile(JitBlock& block);
+  // Returns the block which requested to be recompiled for this address, if any.
+  JitBlock* GetBlockToRecompile(u32 em_address, u32 msr);
+  // Removes a single block from the cache, e.g. once its replacement is compiled.
+  void EraseBlock(JitBlock& block);
+  // Removes all blocks whose host code starts in [start, end), so that the range can be reused.
+  void EraseHostCodeRange(const u8* start, const u8* end);
+
   u32* GetBlockBitSet() const;
 
+  // The block list records every compiled block together with a hash of its
+  // guest instructions. It is kept per game, so that the blocks of a later boot
+  // can be compiled as soon as their code is found in memory, rather than one by
+  // one on first execution.
+  static std::string GetBlockListFileName();
+  void SaveBlockList(const std::string& filename);
+  void LoadBlockList(const std::string& filename);
+
+  // Returns the effective addresses of all listed blocks starting in the same
+  // physical page as physical_address whose guest code is unchanged. Listed
+  // blocks of that page are dropped from the list, whether they matched or not.
+  std::vector<u32> TakeListedBlocks(u32 physical_address, u32 msr);
+
 protected:
   JitBase& m_jit;
 
@@ -162,23 +346,45 @@ private:
   void DestroyBlock(JitBlock& block);
 
   JitBlock* MoveBlockIntoFastCache(u32 em_address, u32 msr);
+  JitBlock* FindBlock(u32 em_address, u32 msr, bool recompile_requested);
+
+  // Blocks are allocated from fixed-size slabs, so their addresses stay stable
+  // and destroyed blocks can be reused without going through the allocator.
+  JitBlock* NewBlock();
+  void FreeBlock(JitBlock* block);
+
+  struct ListedBlock
+  {
+    u32 effective_address;
+    u32 msr_bits;
+    u32 physical_address;
+    u64 guest_hash;
+    std::vector<u32> physical_addresses;
+  };
 
   // Fast but risky block lookup based on fast_block_map.
   size_t FastLookupIndexForAddress(u32 address);
 
   // links_to hold all exit points of all valid blocks in a reverse way.
   // It is used to query all blocks which links to an address.
-  std::multimap<u32, JitBlock*> links_to;  // destination_PC -> number
+  IntrusiveHashTable<JitBlock::LinkData, &JitBlock::LinkData::exitAddress,
+                     &JitBlock::LinkData::next_link>
+      links_to;  // destination_PC -> exit
 
   // Map indexed by the physical address of the entry point.
   // This is used to query the block based on the current PC in a slow way.
-  std::multimap<u32, JitBlock> block_map;  // start_addr -> block
+  IntrusiveHashTable<JitBlock, &JitBlock::physicalAddress, &JitBlock::next_block>
+      block_map;  // start_addr -> block
+
+  static constexpr size_t BLOCK_SLAB_SIZE = 0x400;
+  std::vector<std::unique_ptr<JitBlock[]>> block_slabs;
+  std::vector<JitBlock*> free_blocks;
 
   // Range of overlapping code indexed by a masked physical address.
   // This is used for invalidation of memory regions. The range is grouped
   // in macro blocks of each 0x100 bytes.
   static constexpr u32 BLOCK_RANGE_MAP_ELEMENTS = 0x100;
-  std::map<u32, std::set<JitBlock*>> block_range_map;
+  BlockRangeMap block_range_map;
 
   // This bitsets shows which cachelines overlap with any blocks.
   // It is used to provide a fast way to query if no icache invalidation is needed.
@@ -187,4 +393,9 @@ private:
   // This array is indexed with the masked PC and likely holds the correct block id.
   // This is used as a fast cache of block_map used in the assembly dispatcher.
   std::array<JitBlock*, FAST_BLOCK_MAP_ELEMENTS> fast_block_map;  // start_addr & mask -> number
+
+  // Blocks loaded from the block list which haven't been compiled yet, grouped
+  // by the physical page of their entry point.
+  static constexpr u32 BLOCK_LIST_PAGE_SHIFT = 12;
+  std::map<u32, std::vector<ListedBlock>> listed_blocks;
 };
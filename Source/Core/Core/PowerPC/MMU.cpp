@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <array>
 #include <cstddef>
 #include <cstring>
 #include <string>
@@ -110,6 +111,108 @@ struct TranslateAddressResult
 template <const XCheckTLBFlag flag>
 static TranslateAddressResult TranslateAddress(u32 address);
 
+// A direct mapped cache from effective pages to host memory, for data accesses which have to be
+// translated outside of fastmem. Entries are only made for pages which are translated by a BAT or
+// present in the emulated data TLB, and are dropped whenever that stops being the case, so a hit
+// gives exactly the same result as walking the BATs and the TLB would.
+struct TranslationCacheEntry
+{
+  static constexpr u32 INVALID_TAG = 0xffffffff;
+  static constexpr u8 FROM_BAT = 0xff;
+
+  u32 tag = INVALID_TAG;
+  // Which way of the emulated TLB set the translation came from, to keep its LRU bit up to date.
+  u8 tlb_way = FROM_BAT;
+  u8* host_page = nullptr;
+};
+
+constexpr u32 TRANSLATION_CACHE_SIZE = 4096;
+using TranslationCache = std::array<TranslationCacheEntry, TRANSLATION_CACHE_SIZE>;
+
+// Reads and writes have separate caches, since a page only gets a write entry once its PTE has
+// the C bit set.
+static std::array<TranslationCache, 2> s_translation_cache;
+
+static u8* GetHostPage(u32 physical_page)
+{
+  // This has to match the regions ReadFromHardware and WriteToHardware handle as plain memory.
+  if ((physical_page & 0xF8000000) == 0x00000000)
+    return &Memory::m_pRAM[physical_page & Memory::RAM_MASK];
+  if (Memory::m_pEXRAM && (physical_page >> 28) == 0x1 &&
+      (physical_page & 0x0FFFFFFF) < Memory::EXRAM_SIZE)
+  {
+    return &Memory::m_pEXRAM[physical_page & 0x0FFFFFFF];
+  }
+  if ((physical_page >> 28) == 0xE && (physical_page < (0xE0000000 + Memory::L1_CACHE_SIZE)))
+    return &Memory::m_pL1Cache[physical_page & 0x0FFFFFFF];
+  if (Memory::m_pFakeVMEM && ((physical_page & 0xFE000000) == 0x7E000000))
+    return &Memory::m_pFakeVMEM[physical_page & Memory::RAM_MASK];
+  return nullptr;
+}
+
+// Returns a pointer to the host memory backing the address, or nullptr if it isn't cached.
+template <const XCheckTLBFlag flag>
+static u8* LookupTranslationCache(u32 address)
+{
+  static_assert(flag == FLAG_READ || flag == FLAG_WRITE, "Only data accesses are cached");
+
+  const u32 tag = address >> HW_PAGE_INDEX_SHIFT;
+  const TranslationCacheEntry& entry =
+      s_translation_cache[flag == FLAG_WRITE][tag % TRANSLATION_CACHE_SIZE];
+  if (entry.tag != tag)
+    return nullptr;
+
+  if (entry.tlb_way != TranslationCacheEntry::FROM_BAT)
+    ppcState.tlb[0][tag & HW_PAGE_INDEX_MASK].recent = entry.tlb_way;
+  return entry.host_page + (address & (HW_PAGE_SIZE - 1));
+}
+
+template <const XCheckTLBFlag flag>
+static void UpdateTranslationCache(u32 address, const TranslateAddressResult& translated_addr)
+{
+  static_assert(flag == FLAG_READ || flag == FLAG_WRITE, "Only data accesses are cached");
+
+  u8* host_page = GetHostPage(translated_addr.address & ~(HW_PAGE_SIZE - 1));
+  if (!host_page)
+    return;
+
+  const u32 tag = address >> HW_PAGE_INDEX_SHIFT;
+  u8 tlb_way = TranslationCacheEntry::FROM_BAT;
+  if (translated_addr.result == TranslateAddressResult::PAGE_TABLE_TRANSLATED)
+  {
+    const TLBEntry& tlbe = ppcState.tlb[0][tag & HW_PAGE_INDEX_MASK];
+    if (tlbe.tag[0] == tag)
+      tlb_way = 0;
+    else if (tlbe.tag[1] == tag)
+      tlb_way = 1;
+    else
+      return;
+  }
+
+  TranslationCacheEntry& entry =
+      s_translation_cache[flag == FLAG_WRITE][tag % TRANSLATION_CACHE_SIZE];
+  entry.tag = tag;
+  entry.tlb_way = tlb_way;
+  entry.host_page = host_page;
+}
+
+// Drops the entries which were made from the emulated TLB entry for the given page.
+static void InvalidateTranslationCacheEntry(u32 tag)
+{
+  for (TranslationCache& cache : s_translation_cache)
+  {
+    TranslationCacheEntry& entry = cache[tag % TRANSLATION_CACHE_SIZE];
+    if (entry.tag == tag && entry.tlb_way != TranslationCacheEntry::FROM_BAT)
+      entry = {};
+  }
+}
+
+void ClearTranslationCache()
+{
+  for (TranslationCache& cache : s_translation_cache)
+    cache.fill({});
+}
+
 // Nasty but necessary. Super Mario Galaxy pointer relies on this stuff.
 static u32 EFB_Read(const u32 addr)
 {
@@ -170,6 +273,18 @@ static T ReadFromHardware(u32 em_address)
 {
   if (!never_translate && UReg_MSR(MSR).DR)
   {
+    const bool cacheable =
+        flag == FLAG_READ && (em_address & (HW_PAGE_SIZE - 1)) <= HW_PAGE_SIZE - sizeof(T);
+    if (cacheable)
+    {
+      if (const u8* host_address = LookupTranslationCache<FLAG_READ>(em_address))
+      {
+        T value;
+        std::memcpy(&value, host_address, sizeof(T));
+        return bswap(value);
+      }
+    }
+
     auto translated_addr = TranslateAddress<flag>(em_address);
     if (!translated_addr.Success())
     {
@@ -201,6 +316,8 @@ static T ReadFromHardware(u32 em_address)
       }
       return var;
     }
+    if (cacheable)
+      UpdateTranslationCache<FLAG_READ>(em_address, translated_addr);
     em_address = translated_addr.address;
   }
 
@@ -258,6 +375,18 @@ static void WriteToHardware(u32 em_address, const T data)
 {
   if (!never_translate && UReg_MSR(MSR).DR)
   {
+    const bool cacheable =
+        flag == FLAG_WRITE && (em_address & (HW_PAGE_SIZE - 1)) <= HW_PAGE_SIZE - sizeof(T);
+    if (cacheable)
+    {
+      if (u8* host_address = LookupTranslationCache<FLAG_WRITE>(em_address))
+      {
+        const T swapped_data = bswap(data);
+        std::memcpy(host_address, &swapped_data, sizeof(T));
+        return;
+      }
+    }
+
     auto translated_addr = TranslateAddress<flag>(em_address);
     if (!translated_addr.Success())
     {
@@ -290,6 +419,8 @@ static void WriteToHardware(u32 em_address, const T data)
       }
       return;
     }
+    if (cacheable)
+      UpdateTranslationCache<FLAG_WRITE>(em_address, translated_addr);
     em_address = translated_addr.address;
   }
 
@@ -958,6 +1089,7 @@ void SDRUpdated()
   }
   PowerPC::ppcState.pagetable_base = htaborg << 16;
   PowerPC::ppcState.pagetable_hashmask = ((htabmask << 10) | 0x3ff);
+  ClearTranslationCache();
 }
 
 enum TLBLookupResult
@@ -1027,6 +1159,8 @@ static void UpdateTLBEntry(const XCheckTLBFlag flag, UPTE2 PTE2, const u32 addre
   const int tag = address >> HW_PAGE_INDEX_SHIFT;
   TLBEntry& tlbe = ppcState.tlb[IsOpcodeFlag(flag)][tag & HW_PAGE_INDEX_MASK];
   const int index = tlbe.recent == 0 && tlbe.tag[0] != TLBEntry::INVALID_TAG;
+  if (!IsOpcodeFlag(flag) && tlbe.tag[index] != TLBEntry::INVALID_TAG)
+    InvalidateTranslationCacheEntry(tlbe.tag[index]);
   tlbe.recent = index;
   tlbe.paddr[index] = PTE2.RPN << HW_PAGE_INDEX_SHIFT;
   tlbe.pte[index] = PTE2.Hex;
@@ -1038,6 +1172,11 @@ void InvalidateTLBEntry(u32 address)
   const u32 entry_index = (address >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK;
 
   TLBEntry& tlbe = ppcState.tlb[0][entry_index];
+  for (u32 tag : tlbe.tag)
+  {
+    if (tag != TLBEntry::INVALID_TAG)
+      InvalidateTranslationCacheEntry(tag);
+  }
   tlbe.tag[0] = TLBEntry::INVALID_TAG;
   tlbe.tag[1] = TLBEntry::INVALID_TAG;
 
@@ -1229,6 +1368,7 @@ static void UpdateFakeMMUBat(BatTable& bat_table, u32 start_addr)
 void DBATUpdated()
 {
   dbat_table = {};
+  ClearTranslationCache();
   UpdateBATs(dbat_table, SPR_DBAT0U);
   bool extended_bats = SConfig::GetInstance().bWii && HID4.SBE;
   if (extended_bats)
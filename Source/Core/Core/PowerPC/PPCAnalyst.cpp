@@ -39,6 +39,12 @@ constexpr int CODEBUFFER_SIZE = 32000;
 // 0 does not perform block merging
 constexpr u32 BRANCH_FOLLOWING_THRESHOLD = 2;
 
+// Maximum number of conditional branches a trace may follow.
+constexpr u32 TRACE_FOLLOWING_THRESHOLD = 4;
+
+// Longest loop body (including the branch) considered for idle loop detection.
+constexpr u32 IDLE_LOOP_MAX_INSTRUCTIONS = 16;
+
 constexpr u32 INVALID_BRANCH_TARGET = 0xFFFFFFFF;
 
 CodeBuffer::CodeBuffer(int size)
@@ -682,6 +688,63 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock* block, CodeOp* code, const Gekk
   }
 }
 
+// The static branch prediction of the 750: backward conditional branches are predicted
+// taken and forward ones not taken, unless the y bit of BO reverses the prediction.
+static bool IsPredictedTaken(UGeckoInstruction inst)
+{
+  const bool backward = SignExt16(inst.BD << 2) < 0;
+  return backward != ((inst.BO & 1) != 0);
+}
+
+// Looks for a loop from the start of the block back to it which only polls memory, e.g.
+//   lis r3, 0xCC00; lhz r0, 0x6C(r3); rlwinm. r0, r0, 0, 16, 16; beq <start>
+// Such a loop has no side effects and computes the same values on every iteration unless
+// the memory it reads changes, so the JIT can skip ahead to the next event.
+// All instructions are loads or integer ops, and every register they read is either
+// written earlier in the same iteration or not at all within the loop.
+static void FindIdleLoop(u32 address, CodeOp* code, u32 num_instructions)
+{
+  const u32 max_instructions = std::min(num_instructions, IDLE_LOOP_MAX_INSTRUCTIONS);
+
+  BitSet32 written;
+  BitSet32 written_in_loop;
+  for (u32 i = 0; i < max_instructions; ++i)
+  {
+    const CodeOp& op = code[i];
+    if (op.address != address + i * 4)
+      return;
+    written_in_loop |= op.regsOut;
+    // Whatever follows the branch is not part of the loop.
+    if (op.opinfo->type == OPTYPE_BRANCH)
+      break;
+  }
+
+  for (u32 i = 0; i < max_instructions; ++i)
+  {
+    CodeOp& op = code[i];
+    const UGeckoInstruction inst = op.inst;
+    if (op.opinfo->type == OPTYPE_BRANCH)
+    {
+      if (i != 0 && inst.OPCD == 16 && !inst.LK && !inst.AA &&
+          (inst.BO & BO_DONT_DECREMENT_FLAG) && op.address + SignExt16(inst.BD << 2) == address)
+      {
+        op.branchIsIdleLoop = true;
+      }
+      return;
+    }
+
+    if (op.opinfo->type != OPTYPE_INTEGER && op.opinfo->type != OPTYPE_LOAD)
+      return;
+    if (op.opinfo->flags & (FL_EVIL | FL_READ_CA | FL_SET_OE))
+      return;
+
+    // A value carried over from the previous iteration.
+    if (op.regsIn & written_in_loop & ~written)
+      return;
+    written |= op.regsOut;
+  }
+}
+
 u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32 blockSize)
 {
   // Clear block stats
@@ -710,6 +773,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
   bool found_call = false;
   size_t caller = 0;
   u32 numFollows = 0;
+  u32 num_trace_follows = 0;
   u32 num_inst = 0;
 
   for (u32 i = 0; i < blockSize; ++i)
@@ -831,6 +895,25 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
       }
     }
 
+    if (conditional_continue && HasOption(OPTION_TRACE_FOLLOW) && inst.OPCD == 16 && !inst.LK &&
+        blockSize > 1 && num_trace_follows < TRACE_FOLLOWING_THRESHOLD && IsPredictedTaken(inst))
+    {
+      const u32 target = SignExt16(inst.BD << 2) + (inst.AA ? 0 : address);
+
+      // Branching back into the block would only unroll the loop; block linking handles that.
+      const bool target_in_block = std::any_of(
+          code, code + i + 1, [target](const CodeOp& op) { return op.address == target; });
+      if (!target_in_block)
+      {
+        code[i].branchIsFollowed = true;
+        num_trace_follows++;
+        // As for conditional continuing, we can't guarantee the matching CALL/RET pair.
+        found_call = false;
+        address = target;
+        continue;
+      }
+    }
+
     if (follow)
     {
       // Follow the unconditional branch.
@@ -857,6 +940,8 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
 
   block->m_num_instructions = num_inst;
 
+  FindIdleLoop(block->m_address, code, block->m_num_instructions);
+
   if (block->m_num_instructions > 1)
     ReorderInstructions(block->m_num_instructions, code);
 
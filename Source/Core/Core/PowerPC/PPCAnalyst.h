@@ -44,6 +44,12 @@ struct CodeOp  // 16B
   bool canEndBlock;
   bool skipLRStack;
   bool skip;  // followed BL-s for example
+  // Conditional branch whose target was appended to the block by trace formation.
+  // The JIT only has to exit the block if the branch is not taken.
+  bool branchIsFollowed;
+  // Branch back to the start of a loop which can only leave once an external event
+  // (an interrupt, DMA or another thread) changes the memory it reads.
+  bool branchIsIdleLoop;
   // which registers are still needed after this instruction in this block
   BitSet32 fprInUse;
   BitSet32 gprInUse;
@@ -218,6 +224,12 @@ public:
 
     // Reorder cror instructions next to their associated fcmp.
     OPTION_CROR_MERGE = (1 << 6),
+
+    // Trace formation: continue the block at the target of conditional branches which
+    // are predicted taken, instead of at the next instruction. This keeps registers
+    // cached along the likely path.
+    // Requires JIT support (CodeOp::branchIsFollowed).
+    OPTION_TRACE_FOLLOW = (1 << 7),
   };
 
   PPCAnalyzer() : m_options(0) {}
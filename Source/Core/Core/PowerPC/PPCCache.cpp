@@ -17,7 +17,11 @@ namespace PowerPC
 static const u32 s_plru_mask[8] = {11, 11, 19, 19, 37, 37, 69, 69};
 static const u32 s_plru_value[8] = {11, 3, 17, 1, 36, 4, 64, 0};
 
+// Line addresses are aligned, so this never matches one.
+static const u32 NO_FETCHED_LINE = 1;
+
 InstructionCache::InstructionCache()
+    : fetched_line_address(NO_FETCHED_LINE), fetched_line(nullptr)
 {
   for (u32 m = 0; m < 0xff; m++)
   {
@@ -63,6 +67,7 @@ void InstructionCache::Reset()
   memset(lookup_table, 0xff, sizeof(lookup_table));
   memset(lookup_table_ex, 0xff, sizeof(lookup_table_ex));
   memset(lookup_table_vmem, 0xff, sizeof(lookup_table_vmem));
+  fetched_line_address = NO_FETCHED_LINE;
   JitInterface::ClearSafe();
 }
 
@@ -91,6 +96,7 @@ void InstructionCache::Invalidate(u32 addr)
         lookup_table[((tags[set][i] << 7) | set) & 0xfffff] = 0xff;
     }
   valid[set] = 0;
+  fetched_line_address = NO_FETCHED_LINE;
   JitInterface::InvalidateICache(addr & ~0x1f, 32, false);
 }
 
@@ -98,6 +104,9 @@ u32 InstructionCache::ReadInstruction(u32 addr)
 {
   if (!HID0.ICE)  // instruction cache is disabled
     return Memory::Read_U32(addr);
+  if ((addr & ~0x1f) == fetched_line_address)
+    return Common::swap32(fetched_line[(addr >> 2) & 7]);
+
   u32 set = (addr >> 5) & 0x7f;
   u32 tag = addr >> 12;
 
@@ -147,6 +156,8 @@ u32 InstructionCache::ReadInstruction(u32 addr)
   }
   // update plru
   plru[set] = (plru[set] & ~s_plru_mask[t]) | s_plru_value[t];
+  fetched_line_address = addr & ~0x1f;
+  fetched_line = data[set][t];
   u32 res = Common::swap32(data[set][t][(addr >> 2) & 7]);
   return res;
 }
@@ -162,5 +173,8 @@ void InstructionCache::DoState(PointerWrap& p)
   p.DoArray(lookup_table);
   p.DoArray(lookup_table_ex);
   p.DoArray(lookup_table_vmem);
+
+  if (p.GetMode() == PointerWrap::MODE_READ)
+    fetched_line_address = NO_FETCHED_LINE;
 }
 }  // namespace PowerPC
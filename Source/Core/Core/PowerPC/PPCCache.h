@@ -32,6 +32,13 @@ struct InstructionCache
   u8 lookup_table_ex[1 << 21];
   u8 lookup_table_vmem[1 << 20];
 
+  // The line which the last instruction was fetched from. Fetches from the same line can skip
+  // the tag lookup, since nothing but Invalidate and Reset can evict the most recently used line,
+  // and updating the PLRU bits for the same way again doesn't change them.
+  // Not part of the savestate, since it's only a shortcut to the state above.
+  u32 fetched_line_address;
+  const u32* fetched_line;
+
   InstructionCache();
   u32 ReadInstruction(u32 addr);
   void Invalidate(u32 addr);
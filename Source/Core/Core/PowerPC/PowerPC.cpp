@@ -229,6 +229,7 @@ void Reset()
   ppcState.pagetable_base = 0;
   ppcState.pagetable_hashmask = 0;
   ppcState.tlb = {};
+  ClearTranslationCache();
 
   ResetRegisters();
   ppcState.iCache.Reset();
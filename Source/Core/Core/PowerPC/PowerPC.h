@@ -274,6 +274,7 @@ void ClearCacheLine(u32 address);  // Zeroes 32 bytes; address should be 32-byte
 // TLB functions
 void SDRUpdated();
 void InvalidateTLBEntry(u32 address);
+void ClearTranslationCache();
 void DBATUpdated();
 void IBATUpdated();
 
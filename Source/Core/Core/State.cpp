@@ -4,8 +4,10 @@
 
 #include "Core/State.h"
 
+#include <cstring>
 #include <lzo/lzo1x.h>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -16,6 +18,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
 #include "Common/File.h"
+#include "Common/Flag.h"
 #include "Common/FileUtil.h"
 #include "Common/MsgHandler.h"
 #include "Common/ScopeGuard.h"
@@ -33,6 +36,9 @@
 #include "Core/Movie.h"
 #include "Core/NetPlayClient.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/StateCompression.h"
+#include "Core/StateDelta.h"
+#include "Core/StateRewind.h"
 
 #include "VideoCommon/AVIDump.h"
 #include "VideoCommon/OnScreenDisplay.h"
@@ -40,23 +46,6 @@
 
 namespace State
 {
-#if defined(__LZO_STRICT_16BIT)
-static const u32 IN_LEN = 8 * 1024u;
-#elif defined(LZO_ARCH_I086) && !defined(LZO_HAVE_MM_HUGE_ARRAY)
-static const u32 IN_LEN = 60 * 1024u;
-#else
-static const u32 IN_LEN = 128 * 1024u;
-#endif
-
-static const u32 OUT_LEN = IN_LEN + (IN_LEN / 16) + 64 + 3;
-
-static unsigned char __LZO_MMODEL out[OUT_LEN];
-
-#define HEAP_ALLOC(var, size)                                                                      \
-  lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
-
-static HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
-
 static std::string g_last_filename;
 
 static AfterLoadCallbackFunc s_on_after_load_callback;
@@ -73,7 +62,7 @@ static Common::Event g_compressAndDumpStateSyncEvent;
 static std::thread g_save_thread;
 
 // Don't forget to increase this after doing changes on the savestate system
-static const u32 STATE_VERSION = 88;  // Last changed in PR 5733
+static const u32 STATE_VERSION = 89;  // Last changed for chunked compression
 
 // Maps savestate versions to Dolphin versions.
 // Versions after 42 don't need to be added to this list,
@@ -100,11 +89,40 @@ enum
 
 static bool g_use_compression = true;
 
+static bool g_use_deltas = false;
+// Keeps the state which the next delta state is made against. Only accessed from the CPU thread.
+static DeltaStateSaver g_delta_saver;
+
+// Rewind snapshots are captured by a host job and then compressed on their own thread.
+static std::unique_ptr<RewindBuffer> g_rewind_buffer;
+static std::mutex g_cs_rewind_buffer;
+static std::thread g_rewind_thread;
+static Common::Flag g_rewind_thread_running;
+static Common::Event g_rewind_capture_event;
+// Set while a snapshot is being captured or compressed. Frames which are due for a snapshot
+// in the meantime are skipped.
+static Common::Flag g_rewind_busy;
+static std::mutex g_cs_rewind_capture;
+static RecordedState g_rewind_capture;
+static bool g_rewind_capture_pending = false;
+// The buffer of an older snapshot, which the next one is captured into.
+static std::vector<u8> g_rewind_spare_buffer;
+// Only accessed from the CPU thread.
+static int g_rewind_frame_counter = 0;
+
 void EnableCompression(bool compression)
 {
   g_use_compression = compression;
 }
 
+void EnableDeltas(bool deltas)
+{
+  Core::RunAsCPUThread([&] {
+    g_use_deltas = deltas;
+    g_delta_saver.Reset();
+  });
+}
+
 // Returns true if state version matches current Dolphin state version, false otherwise.
 static bool DoStateVersion(PointerWrap& p, std::string* version_created_by)
 {
@@ -354,33 +372,8 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 
   if (header.size != 0)  // non-zero header size means the state is compressed
   {
-    lzo_uint i = 0;
-    while (true)
-    {
-      lzo_uint32 cur_len = 0;
-      lzo_uint out_len = 0;
-
-      if ((i + IN_LEN) >= buffer_size)
-      {
-        cur_len = (lzo_uint32)(buffer_size - i);
-      }
-      else
-      {
-        cur_len = IN_LEN;
-      }
-
-      if (lzo1x_1_compress(buffer_data + i, cur_len, out, &out_len, wrkmem) != LZO_E_OK)
-        PanicAlertT("Internal LZO Error - compression failed");
-
-      // The size of the data to write is 'out_len'
-      f.WriteArray((lzo_uint32*)&out_len, 1);
-      f.WriteBytes(out, out_len);
-
-      if (cur_len != IN_LEN)
-        break;
-
-      i += cur_len;
-    }
+    const std::vector<u8> compressed = CompressState(buffer_data, buffer_size);
+    f.WriteBytes(compressed.data(), compressed.size());
   }
   else  // uncompressed
   {
@@ -406,7 +399,16 @@ void SaveAs(const std::string& filename, bool wait)
       g_current_buffer.resize(buffer_size);
       ptr = &g_current_buffer[0];
       p.SetMode(PointerWrap::MODE_WRITE);
+      std::vector<PointerWrap::LargeArray> large_arrays;
+      if (g_use_deltas)
+        p.RecordLargeArrays(&large_arrays);
       DoState(p);
+
+      if (g_use_deltas && p.GetMode() == PointerWrap::MODE_WRITE)
+      {
+        g_current_buffer =
+            g_delta_saver.Save(filename, {std::move(g_current_buffer), std::move(large_arrays)});
+      }
     }
 
     if (p.GetMode() == PointerWrap::MODE_WRITE)
@@ -460,8 +462,15 @@ std::string GetInfoStringOfSlot(int slot, bool translate)
   return Common::Timer::GetDateTimeFormatted(header.time);
 }
 
-static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_data)
+// The files which the state was resolved from are added to chain, starting with filename.
+static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_data,
+                              std::vector<std::string>* chain = nullptr)
 {
+  std::vector<std::string> own_chain;
+  if (!chain)
+    chain = &own_chain;
+  chain->push_back(filename);
+
   Flush();
   File::IOFile f(filename, "rb");
   if (!f)
@@ -486,29 +495,13 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
   {
     Core::DisplayMessage("Decompressing State...", 500);
 
-    buffer.resize(header.size);
-
-    lzo_uint i = 0;
-    while (true)
+    const size_t size = (size_t)(f.GetSize() - sizeof(StateHeader));
+    std::vector<u8> compressed(size);
+    if (!f.ReadBytes(compressed.data(), size) ||
+        !DecompressState(compressed.data(), size, header.size, &buffer))
     {
-      lzo_uint32 cur_len = 0;  // number of bytes to read
-      lzo_uint new_len = 0;    // number of bytes to write
-
-      if (!f.ReadArray(&cur_len, 1))
-        break;
-
-      f.ReadBytes(out, cur_len);
-      const int res = lzo1x_decompress(out, cur_len, &buffer[i], &new_len, nullptr);
-      if (res != LZO_E_OK)
-      {
-        // This doesn't seem to happen anymore.
-        PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
-                    "Try loading the state again",
-                    res, i, new_len);
-        return;
-      }
-
-      i += new_len;
+      Core::DisplayMessage("State is corrupted", 2000);
+      return;
     }
   }
   else  // uncompressed
@@ -523,6 +516,22 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
     }
   }
 
+  if (IsDeltaState(buffer))
+  {
+    const auto read_base = [](const std::string& base_filename, std::vector<std::string>* files) {
+      std::vector<u8> base;
+      LoadFileStateData(base_filename, base, files);
+      return base;
+    };
+    std::string error;
+    if (!ResolveDeltaState(filename, &buffer, chain, read_base, &error))
+    {
+      if (!error.empty())
+        Core::DisplayMessage(error, 2000);
+      return;
+    }
+  }
+
   // all good
   ret_data.swap(buffer);
 }
@@ -560,15 +569,22 @@ void LoadAs(const std::string& filename)
     // brackets here are so buffer gets freed ASAP
     {
       std::vector<u8> buffer;
-      LoadFileStateData(filename, buffer);
+      std::vector<std::string> chain;
+      LoadFileStateData(filename, buffer, &chain);
 
       if (!buffer.empty())
       {
         u8* ptr = &buffer[0];
         PointerWrap p(&ptr, PointerWrap::MODE_READ);
+        std::vector<PointerWrap::LargeArray> large_arrays;
+        if (g_use_deltas)
+          p.RecordLargeArrays(&large_arrays);
         version_created_by = DoState(p);
         loaded = true;
         loadedSuccessfully = (p.GetMode() == PointerWrap::MODE_READ);
+
+        if (g_use_deltas && loadedSuccessfully)
+          g_delta_saver.SetLoaded(std::move(chain), {std::move(buffer), std::move(large_arrays)});
       }
     }
 
@@ -628,15 +644,189 @@ void VerifyAt(const std::string& filename)
   });
 }
 
+static void RewindThread()
+{
+  Common::SetCurrentThreadName("Rewind thread");
+
+  while (true)
+  {
+    g_rewind_capture_event.Wait();
+    if (!g_rewind_thread_running.IsSet())
+      return;
+
+    RecordedState state;
+    {
+      std::lock_guard<std::mutex> lk(g_cs_rewind_capture);
+      if (!g_rewind_capture_pending)
+        continue;
+      state = std::move(g_rewind_capture);
+      g_rewind_capture_pending = false;
+    }
+
+    std::vector<u8> spare_buffer;
+    {
+      std::lock_guard<std::mutex> lk(g_cs_rewind_buffer);
+      spare_buffer = g_rewind_buffer->Push(std::move(state));
+    }
+    {
+      std::lock_guard<std::mutex> lk(g_cs_rewind_capture);
+      if (spare_buffer.capacity() > g_rewind_spare_buffer.capacity())
+        g_rewind_spare_buffer.swap(spare_buffer);
+    }
+    g_rewind_busy.Clear();
+  }
+}
+
+static void StartRewindThread()
+{
+  const SConfig& config = SConfig::GetInstance();
+  g_rewind_buffer =
+      std::make_unique<RewindBuffer>(static_cast<size_t>(config.iRewindMemory) * 1024 * 1024);
+  g_rewind_frame_counter = 0;
+  g_rewind_busy.Clear();
+  g_rewind_thread_running.Set();
+  g_rewind_thread = std::thread(RewindThread);
+}
+
+static void StopRewindThread()
+{
+  if (!g_rewind_thread.joinable())
+    return;
+
+  g_rewind_thread_running.Clear();
+  g_rewind_capture_event.Set();
+  g_rewind_thread.join();
+
+  // Rewind() may still be running on the host thread.
+  {
+    std::lock_guard<std::mutex> lk(g_cs_rewind_capture);
+    g_rewind_capture = {};
+    g_rewind_capture_pending = false;
+    g_rewind_spare_buffer = {};
+  }
+  {
+    std::lock_guard<std::mutex> lk(g_cs_rewind_buffer);
+    g_rewind_buffer.reset();
+  }
+}
+
+// Runs on the host thread, because the CPU thread can't pause itself at a point where
+// the state is consistent.
+static void CaptureRewindSnapshot()
+{
+  if (!g_rewind_thread_running.IsSet() || !Core::IsRunningAndStarted())
+  {
+    g_rewind_busy.Clear();
+    return;
+  }
+
+  // The state is written into the buffer of an older snapshot in a single pass. Only when it
+  // doesn't fit, which is the case for the first snapshot, is it written again after growing
+  // the buffer, with some room to spare for the variable sized parts of the state.
+  RecordedState state;
+  {
+    std::lock_guard<std::mutex> lk(g_cs_rewind_capture);
+    state.buffer.swap(g_rewind_spare_buffer);
+  }
+  state.buffer.resize(state.buffer.capacity());
+
+  bool success = false;
+  Core::RunAsCPUThread([&] {
+    for (int attempt = 0; attempt < 2 && !success; attempt++)
+    {
+      u8* ptr = state.buffer.data();
+      PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+      p.SetWriteLimit(state.buffer.data() + state.buffer.size());
+      state.large_arrays.clear();
+      p.RecordLargeArrays(&state.large_arrays);
+      DoState(p);
+
+      const size_t size = ptr - state.buffer.data();
+      success = p.GetMode() == PointerWrap::MODE_WRITE;
+      if (success)
+        state.buffer.resize(size);
+      else if (size > state.buffer.size())
+        state.buffer = std::vector<u8>(size + size / 64);
+      else
+        break;
+    }
+  });
+
+  if (!success)
+  {
+    g_rewind_busy.Clear();
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(g_cs_rewind_capture);
+    g_rewind_capture = std::move(state);
+    g_rewind_capture_pending = true;
+  }
+  g_rewind_capture_event.Set();
+}
+
+void RewindFrameUpdate()
+{
+  if (!g_rewind_thread_running.IsSet() || NetPlay::IsNetPlayRunning())
+    return;
+
+  if (++g_rewind_frame_counter < SConfig::GetInstance().iRewindInterval)
+    return;
+  g_rewind_frame_counter = 0;
+
+  if (g_rewind_busy.TestAndSet())
+    Core::QueueHostJob(CaptureRewindSnapshot);
+}
+
+void Rewind()
+{
+  if (!g_rewind_thread_running.IsSet())
+    return;
+
+  // A snapshot which hasn't been compressed yet is the newest one, so it is used directly.
+  std::vector<u8> buffer;
+  {
+    std::lock_guard<std::mutex> lk(g_cs_rewind_capture);
+    if (g_rewind_capture_pending)
+    {
+      buffer = std::move(g_rewind_capture.buffer);
+      g_rewind_capture = {};
+      g_rewind_capture_pending = false;
+      g_rewind_busy.Clear();
+    }
+  }
+
+  if (buffer.empty())
+  {
+    std::lock_guard<std::mutex> lk(g_cs_rewind_buffer);
+    if (!g_rewind_buffer || !g_rewind_buffer->Pop(&buffer))
+    {
+      Core::DisplayMessage("Nothing to rewind to", 2000);
+      return;
+    }
+  }
+
+  LoadFromBuffer(buffer);
+}
+
 void Init()
 {
   if (lzo_init() != LZO_E_OK)
     PanicAlertT("Internal LZO Error - lzo_init() failed");
+
+  g_use_deltas = SConfig::GetInstance().bDeltaSavestates;
+  g_delta_saver.Reset();
+
+  if (SConfig::GetInstance().bRewind)
+    StartRewindThread();
 }
 
 void Shutdown()
 {
   Flush();
+  StopRewindThread();
+  g_delta_saver.Reset();
 
   // swapping with an empty vector, rather than clear()ing
   // this gives a better guarantee to free the allocated memory right NOW (as opposed to, actually,
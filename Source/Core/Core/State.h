@@ -30,6 +30,12 @@ void Shutdown();
 
 void EnableCompression(bool compression);
 
+// While deltas are enabled, SaveAs only stores what changed since the previous state saved
+// or loaded with SaveAs/LoadAs, and refers to that state's file for everything else.
+// The previous state is kept in memory for this. LoadAs follows chains of delta states.
+// Init enables them if Core/DeltaSavestates is set.
+void EnableDeltas(bool deltas);
+
 bool ReadHeader(const std::string& filename, StateHeader& header);
 
 // Returns a string containing information of the savestate in the given slot
@@ -53,6 +59,12 @@ void SaveToBuffer(std::vector<u8>& buffer);
 void LoadFromBuffer(std::vector<u8>& buffer);
 void VerifyBuffer(std::vector<u8>& buffer);
 
+// While rewinding is enabled, a snapshot is kept in memory every Core/RewindInterval fields.
+// Should be called from the CPU thread at the end of every field.
+void RewindFrameUpdate();
+// Loads the newest snapshot and drops it, so that calling it again goes further back.
+void Rewind();
+
 void LoadLastSaved(int i = 1);
 void SaveFirstSaved();
 void UndoSaveState();
@@ -0,0 +1,204 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/StateCompression.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <lzo/lzo1x.h>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace State
+{
+namespace
+{
+// Older versions wrote the chunks as a stream of compressed sizes followed by the data.
+// The magic is larger than any of those sizes, so the formats can't be mistaken for each other.
+constexpr u32 CHUNKED_STATE_MAGIC = 0x4B4E4843;  // "CHNK"
+constexpr u32 CHUNKED_STATE_VERSION = 1;
+constexpr u32 CHUNK_SIZE = 128 * 1024;
+
+constexpr size_t GetMaxCompressedSize(size_t size)
+{
+  return size + size / 16 + 64 + 3;
+}
+
+enum class ChunkCodec : u32
+{
+  LZO1X_1 = 0,
+};
+
+// Followed by the compressed size of every chunk and then the chunks themselves.
+// A chunk which didn't get smaller is stored as is, which is told apart by its size.
+struct ChunkedStateHeader
+{
+  u32 magic;
+  u32 version;
+  ChunkCodec codec;
+  u32 chunk_size;
+  u32 num_chunks;
+};
+
+// Runs func for every chunk on as many threads as there are cores.
+template <typename Func>
+void ForEachChunk(u32 num_chunks, Func func)
+{
+  const u32 num_threads = std::min(std::max(std::thread::hardware_concurrency(), 1u), num_chunks);
+  std::atomic<u32> next_chunk{0};
+  auto worker = [&] {
+    u32 chunk;
+    while ((chunk = next_chunk++) < num_chunks)
+      func(chunk);
+  };
+
+  std::vector<std::thread> threads;
+  for (u32 i = 1; i < num_threads; i++)
+    threads.emplace_back(worker);
+  worker();
+  for (std::thread& thread : threads)
+    thread.join();
+}
+
+bool DecompressLZOStream(const u8* data, size_t size, size_t state_size, std::vector<u8>* state)
+{
+  state->resize(state_size);
+
+  size_t position = 0;
+  size_t state_position = 0;
+  while (size - position >= sizeof(u32))
+  {
+    u32 chunk_size;
+    std::memcpy(&chunk_size, data + position, sizeof(chunk_size));
+    position += sizeof(chunk_size);
+    if (chunk_size > size - position)
+      return false;
+
+    lzo_uint new_len = state_size - state_position;
+    if (lzo1x_decompress_safe(data + position, chunk_size, state->data() + state_position,
+                              &new_len, nullptr) != LZO_E_OK)
+    {
+      return false;
+    }
+
+    position += chunk_size;
+    state_position += new_len;
+  }
+
+  return state_position == state_size;
+}
+
+bool DecompressChunks(const u8* data, size_t size, size_t state_size, std::vector<u8>* state)
+{
+  ChunkedStateHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (header.version != CHUNKED_STATE_VERSION || header.codec != ChunkCodec::LZO1X_1 ||
+      header.chunk_size == 0 ||
+      header.num_chunks != (state_size + header.chunk_size - 1) / header.chunk_size)
+  {
+    return false;
+  }
+
+  const size_t table_size = header.num_chunks * sizeof(u32);
+  if (size - sizeof(header) < table_size)
+    return false;
+
+  std::vector<u32> chunk_sizes(header.num_chunks);
+  std::memcpy(chunk_sizes.data(), data + sizeof(header), table_size);
+
+  std::vector<size_t> chunk_offsets(header.num_chunks);
+  size_t position = sizeof(header) + table_size;
+  for (u32 i = 0; i < header.num_chunks; i++)
+  {
+    if (chunk_sizes[i] > size - position)
+      return false;
+    chunk_offsets[i] = position;
+    position += chunk_sizes[i];
+  }
+
+  state->resize(state_size);
+  std::atomic<bool> success{true};
+  ForEachChunk(header.num_chunks, [&](u32 chunk) {
+    const size_t state_position = static_cast<size_t>(chunk) * header.chunk_size;
+    const size_t length = std::min<size_t>(header.chunk_size, state_size - state_position);
+    const u8* const chunk_data = data + chunk_offsets[chunk];
+    u8* const dest = state->data() + state_position;
+
+    if (chunk_sizes[chunk] == length)
+    {
+      std::memcpy(dest, chunk_data, length);
+      return;
+    }
+
+    lzo_uint new_len = length;
+    if (lzo1x_decompress_safe(chunk_data, chunk_sizes[chunk], dest, &new_len, nullptr) !=
+            LZO_E_OK ||
+        new_len != length)
+    {
+      success = false;
+    }
+  });
+
+  return success;
+}
+}  // Anonymous namespace
+
+std::vector<u8> CompressState(const u8* data, size_t size)
+{
+  ChunkedStateHeader header;
+  header.magic = CHUNKED_STATE_MAGIC;
+  header.version = CHUNKED_STATE_VERSION;
+  header.codec = ChunkCodec::LZO1X_1;
+  header.chunk_size = CHUNK_SIZE;
+  header.num_chunks = static_cast<u32>((size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+  // Every chunk is compressed into its own slot, and the slots are packed together afterwards.
+  const size_t slot_size = GetMaxCompressedSize(CHUNK_SIZE);
+  std::vector<u8> slots(header.num_chunks * slot_size);
+  std::vector<u32> chunk_sizes(header.num_chunks);
+
+  ForEachChunk(header.num_chunks, [&](u32 chunk) {
+    thread_local std::vector<u8> wrkmem(LZO1X_1_MEM_COMPRESS);
+
+    const size_t position = static_cast<size_t>(chunk) * CHUNK_SIZE;
+    const size_t length = std::min<size_t>(CHUNK_SIZE, size - position);
+    u8* const slot = &slots[chunk * slot_size];
+
+    lzo_uint out_len = 0;
+    if (lzo1x_1_compress(data + position, length, slot, &out_len, wrkmem.data()) != LZO_E_OK ||
+        out_len >= length)
+    {
+      std::memcpy(slot, data + position, length);
+      out_len = length;
+    }
+    chunk_sizes[chunk] = static_cast<u32>(out_len);
+  });
+
+  const size_t table_size = header.num_chunks * sizeof(u32);
+  std::vector<u8> result(sizeof(header) + table_size);
+  std::memcpy(result.data(), &header, sizeof(header));
+  std::memcpy(&result[sizeof(header)], chunk_sizes.data(), table_size);
+  for (u32 i = 0; i < header.num_chunks; i++)
+  {
+    const u8* const slot = &slots[i * slot_size];
+    result.insert(result.end(), slot, slot + chunk_sizes[i]);
+  }
+
+  return result;
+}
+
+bool DecompressState(const u8* data, size_t size, size_t state_size, std::vector<u8>* state)
+{
+  u32 magic = 0;
+  if (size >= sizeof(ChunkedStateHeader))
+    std::memcpy(&magic, data, sizeof(magic));
+
+  if (magic == CHUNKED_STATE_MAGIC)
+    return DecompressChunks(data, size, state_size, state);
+  return DecompressLZOStream(data, size, state_size, state);
+}
+}
@@ -0,0 +1,21 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Compression of savestates, which is split into chunks so that it can use all cores.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace State
+{
+std::vector<u8> CompressState(const u8* data, size_t size);
+
+// Handles both the chunked format and the LZO stream which older versions wrote.
+// Fails if the data is corrupted or doesn't decompress to exactly state_size bytes.
+bool DecompressState(const u8* data, size_t size, size_t state_size, std::vector<u8>* state);
+}
@@ -0,0 +1,333 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/StateDelta.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <xxhash.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+
+namespace State
+{
+namespace
+{
+constexpr u32 DELTA_MAGIC = 0x41544C44;  // "DLTA"
+constexpr u32 DELTA_VERSION = 1;
+constexpr size_t DELTA_PAGE_SIZE = 0x1000;
+
+struct DeltaHeader
+{
+  u32 magic;
+  u32 version;
+  u64 base_size;
+  u64 base_hash;
+  u64 state_size;
+};
+
+// Copies length bytes of the base state from base_offset, or if base_offset is LITERAL,
+// the length bytes which follow the op.
+struct DeltaOp
+{
+  static constexpr u64 LITERAL = std::numeric_limits<u64>::max();
+
+  u64 base_offset;
+  u64 length;
+};
+
+using Segment = PointerWrap::LargeArray;
+
+template <typename T>
+void Append(std::vector<u8>* out, const T& value)
+{
+  const u8* bytes = reinterpret_cast<const u8*>(&value);
+  out->insert(out->end(), bytes, bytes + sizeof(T));
+}
+
+// Merges adjacent ops of the same kind.
+class DeltaWriter
+{
+public:
+  DeltaWriter(const std::vector<u8>& state, std::vector<u8>* out) : m_state(state), m_out(out) {}
+
+  void Copy(size_t base_offset, size_t length)
+  {
+    if (m_pending.base_offset != DeltaOp::LITERAL &&
+        m_pending.base_offset + m_pending.length == base_offset)
+    {
+      m_pending.length += length;
+      return;
+    }
+    Flush();
+    m_pending = {base_offset, length};
+  }
+
+  void Literal(size_t state_offset, size_t length)
+  {
+    if (m_pending.base_offset == DeltaOp::LITERAL &&
+        m_literal_offset + m_pending.length == state_offset)
+    {
+      m_pending.length += length;
+      return;
+    }
+    Flush();
+    m_pending = {DeltaOp::LITERAL, length};
+    m_literal_offset = state_offset;
+  }
+
+  void Flush()
+  {
+    if (m_pending.length == 0)
+      return;
+
+    Append(m_out, m_pending);
+    if (m_pending.base_offset == DeltaOp::LITERAL)
+    {
+      const u8* data = m_state.data() + m_literal_offset;
+      m_out->insert(m_out->end(), data, data + m_pending.length);
+    }
+    m_pending = {0, 0};
+  }
+
+private:
+  const std::vector<u8>& m_state;
+  std::vector<u8>* m_out;
+  DeltaOp m_pending{0, 0};
+  size_t m_literal_offset = 0;
+};
+
+constexpr size_t DELTA_STATE_HEADER_SIZE = sizeof(DELTA_STATE_COOKIE) + sizeof(u32);
+
+std::string GetDeltaBasePath(const std::string& filename, const std::string& base_name)
+{
+  // Bases in the same directory are stored without it, so that chains can be moved around.
+  if (base_name.find_first_of("/\\") != std::string::npos)
+    return base_name;
+
+  std::string directory;
+  SplitPath(filename, &directory, nullptr, nullptr);
+  return directory + base_name;
+}
+}  // Anonymous namespace
+
+std::vector<PointerWrap::LargeArray> GetSegments(const RecordedState& state)
+{
+  std::vector<PointerWrap::LargeArray> segments;
+  size_t position = 0;
+  for (const PointerWrap::LargeArray& array : state.large_arrays)
+  {
+    segments.push_back({position, array.offset - position});
+    segments.push_back(array);
+    position = array.offset + array.size;
+  }
+  segments.push_back({position, state.buffer.size() - position});
+  return segments;
+}
+
+std::vector<u8> EncodeDelta(const RecordedState& base, const RecordedState& state)
+{
+  std::vector<u8> out;
+  Append(&out, DeltaHeader{DELTA_MAGIC, DELTA_VERSION, base.buffer.size(),
+                           XXH64(base.buffer.data(), base.buffer.size(), 0), state.buffer.size()});
+
+  const std::vector<Segment> base_segments = GetSegments(base);
+  const std::vector<Segment> segments = GetSegments(state);
+
+  DeltaWriter writer(state.buffer, &out);
+  for (size_t i = 0; i < segments.size(); ++i)
+  {
+    const Segment& segment = segments[i];
+
+    // Segments which can't be lined up with the base are stored as they are.
+    if (i >= base_segments.size() || base_segments[i].size != segment.size)
+    {
+      writer.Literal(segment.offset, segment.size);
+      continue;
+    }
+
+    const Segment& base_segment = base_segments[i];
+    for (size_t offset = 0; offset < segment.size; offset += DELTA_PAGE_SIZE)
+    {
+      const size_t length = std::min(DELTA_PAGE_SIZE, segment.size - offset);
+      if (!std::memcmp(&state.buffer[segment.offset + offset],
+                       &base.buffer[base_segment.offset + offset], length))
+      {
+        writer.Copy(base_segment.offset + offset, length);
+      }
+      else
+      {
+        writer.Literal(segment.offset + offset, length);
+      }
+    }
+  }
+  writer.Flush();
+
+  return out;
+}
+
+bool ApplyDelta(const std::vector<u8>& base, const u8* delta, size_t delta_size,
+                std::vector<u8>* state)
+{
+  DeltaHeader header;
+  if (delta_size < sizeof(header))
+    return false;
+  std::memcpy(&header, delta, sizeof(header));
+  if (header.magic != DELTA_MAGIC || header.version != DELTA_VERSION ||
+      header.base_size != base.size() || header.base_hash != XXH64(base.data(), base.size(), 0))
+  {
+    return false;
+  }
+
+  state->resize(header.state_size);
+  size_t position = sizeof(header);
+  size_t state_position = 0;
+  while (position < delta_size)
+  {
+    DeltaOp op;
+    if (delta_size - position < sizeof(op))
+      return false;
+    std::memcpy(&op, delta + position, sizeof(op));
+    position += sizeof(op);
+
+    if (op.length > state->size() - state_position)
+      return false;
+
+    if (op.base_offset == DeltaOp::LITERAL)
+    {
+      if (op.length > delta_size - position)
+        return false;
+      std::memcpy(state->data() + state_position, delta + position, op.length);
+      position += op.length;
+    }
+    else
+    {
+      if (op.base_offset > base.size() || op.length > base.size() - op.base_offset)
+        return false;
+      std::memcpy(state->data() + state_position, base.data() + op.base_offset, op.length);
+    }
+    state_position += op.length;
+  }
+
+  return state_position == state->size();
+}
+
+const std::string& DeltaChain::GetBase() const
+{
+  static const std::string no_base;
+  return m_files.empty() ? no_base : m_files.front();
+}
+
+bool DeltaChain::CanSaveDelta(const std::string& filename) const
+{
+  return !m_files.empty() && m_files.size() < MAX_DELTA_CHAIN_LENGTH &&
+         std::find(m_files.begin(), m_files.end(), filename) == m_files.end();
+}
+
+void DeltaChain::AddDelta(const std::string& filename)
+{
+  m_files.insert(m_files.begin(), filename);
+}
+
+void DeltaChain::Reset(std::vector<std::string> files)
+{
+  m_files = std::move(files);
+}
+
+bool IsDeltaState(const std::vector<u8>& data)
+{
+  u32 cookie = 0;
+  if (data.size() >= sizeof(cookie))
+    std::memcpy(&cookie, data.data(), sizeof(cookie));
+  return cookie == DELTA_STATE_COOKIE;
+}
+
+std::vector<u8> DeltaStateSaver::Save(const std::string& filename, RecordedState state)
+{
+  std::vector<u8> data;
+
+  // A state can't refer to the file it replaces, not even through other deltas.
+  if (!m_chain.CanSaveDelta(filename))
+  {
+    data = state.buffer;
+    m_chain.Reset({filename});
+  }
+  else
+  {
+    std::string base_directory, base_name, base_extension, directory;
+    SplitPath(m_chain.GetBase(), &base_directory, &base_name, &base_extension);
+    SplitPath(filename, &directory, nullptr, nullptr);
+    const std::string stored_name =
+        base_directory == directory ? base_name + base_extension : m_chain.GetBase();
+
+    const std::vector<u8> delta = EncodeDelta(m_base, state);
+    const u32 name_size = static_cast<u32>(stored_name.size());
+    Append(&data, DELTA_STATE_COOKIE);
+    Append(&data, name_size);
+    data.insert(data.end(), stored_name.begin(), stored_name.end());
+    data.insert(data.end(), delta.begin(), delta.end());
+    m_chain.AddDelta(filename);
+  }
+
+  m_base = std::move(state);
+  return data;
+}
+
+void DeltaStateSaver::SetLoaded(std::vector<std::string> files, RecordedState state)
+{
+  m_chain.Reset(std::move(files));
+  m_base = std::move(state);
+}
+
+void DeltaStateSaver::Reset()
+{
+  m_chain.Reset();
+  m_base = {};
+}
+
+bool ResolveDeltaState(const std::string& filename, std::vector<u8>* data,
+                       std::vector<std::string>* chain, const ReadStateFunction& read_state,
+                       std::string* error)
+{
+  u32 name_size = 0;
+  if (data->size() >= DELTA_STATE_HEADER_SIZE)
+    std::memcpy(&name_size, &(*data)[sizeof(DELTA_STATE_COOKIE)], sizeof(name_size));
+  if (data->size() < DELTA_STATE_HEADER_SIZE ||
+      data->size() - DELTA_STATE_HEADER_SIZE < name_size)
+  {
+    *error = "Delta state is corrupted";
+    return false;
+  }
+
+  if (chain->size() >= MAX_DELTA_CHAIN_LENGTH)
+  {
+    *error = "Chain of delta states is too long";
+    return false;
+  }
+
+  const std::string base_filename = GetDeltaBasePath(
+      filename,
+      std::string(reinterpret_cast<const char*>(&(*data)[DELTA_STATE_HEADER_SIZE]), name_size));
+  const std::vector<u8> base = read_state(base_filename, chain);
+  if (base.empty())
+    return false;
+
+  const size_t delta_offset = DELTA_STATE_HEADER_SIZE + name_size;
+  std::vector<u8> state;
+  if (!ApplyDelta(base, data->data() + delta_offset, data->size() - delta_offset, &state))
+  {
+    *error = StringFromFormat("Delta state doesn't match its base state %s", base_filename.c_str());
+    return false;
+  }
+
+  data->swap(state);
+  return true;
+}
+}  // namespace State
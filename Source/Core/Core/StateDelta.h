@@ -0,0 +1,94 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Delta encoding of savestates against an older state of the same game.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+
+namespace State
+{
+// A state buffer together with the large arrays which were recorded while writing it.
+struct RecordedState
+{
+  std::vector<u8> buffer;
+  std::vector<PointerWrap::LargeArray> large_arrays;
+};
+
+// Splits a state into its large arrays and the data between them. Two states can be compared
+// segment by segment even if the variable sized data in front of an array changed in size.
+std::vector<PointerWrap::LargeArray> GetSegments(const RecordedState& state);
+
+// The states are lined up by their large arrays (e.g. emulated RAM), which are compared
+// page by page. Only the pages which differ from the base end up in the delta.
+std::vector<u8> EncodeDelta(const RecordedState& base, const RecordedState& state);
+
+// Fails if the delta is corrupted or was made against a different base.
+bool ApplyDelta(const std::vector<u8>& base, const u8* delta, size_t delta_size,
+                std::vector<u8>* state);
+
+// Deltas stored in a chain of more files than this aren't loaded, which also stops cycles.
+constexpr size_t MAX_DELTA_CHAIN_LENGTH = 256;
+
+// The files which the base of the next delta state is stored in: the base state itself,
+// then the state it is a delta against, and so on down to a full state.
+class DeltaChain
+{
+public:
+  // Empty if there is no base.
+  const std::string& GetBase() const;
+  // A file can't be saved as a delta if that would overwrite a file of its own chain,
+  // or if the chain would become too long to be loaded.
+  bool CanSaveDelta(const std::string& filename) const;
+
+  // The delta which was saved to filename becomes the new base.
+  void AddDelta(const std::string& filename);
+  // Starts over from a state which was saved in full or loaded through the given files.
+  void Reset(std::vector<std::string> files = {});
+
+private:
+  std::vector<std::string> m_files;
+};
+
+// Delta state files start with this instead of the state version cookie, followed by the
+// file name of their base state and the delta itself.
+constexpr u32 DELTA_STATE_COOKIE = 0x544C4544;  // "DELT"
+
+bool IsDeltaState(const std::vector<u8>& data);
+
+// Makes the data of state files, as deltas against the state which was saved or loaded last
+// wherever the chain allows it.
+class DeltaStateSaver
+{
+public:
+  // Returns the data to store in filename. The state becomes the base of the next delta.
+  std::vector<u8> Save(const std::string& filename, RecordedState state);
+  // Makes a state which was loaded through the given files the base of the next delta.
+  void SetLoaded(std::vector<std::string> files, RecordedState state);
+  void Reset();
+
+private:
+  DeltaChain m_chain;
+  RecordedState m_base;
+};
+
+// Reads the full state stored in a file and adds the files it was read through to chain.
+// Returns an empty buffer on failure.
+using ReadStateFunction =
+    std::function<std::vector<u8>(const std::string& filename, std::vector<std::string>* chain)>;
+
+// Turns the data of a delta state read from filename into the full state by applying it to
+// its base state. On failure, error is set to a message for the user, unless it was reading
+// the base state which failed.
+bool ResolveDeltaState(const std::string& filename, std::vector<u8>* data,
+                       std::vector<std::string>* chain, const ReadStateFunction& read_state,
+                       std::string* error);
+}
@@ -0,0 +1,150 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/StateRewind.h"
+
+#include <algorithm>
+#include <cstring>
+#include <lzo/lzo1x.h>
+#include <utility>
+#include <vector>
+
+#include "Common/Assert.h"
+#include "Common/CommonTypes.h"
+
+namespace State
+{
+static constexpr size_t REWIND_PAGE_SIZE = 0x1000;
+
+static size_t GetPageCount(size_t size)
+{
+  return (size + REWIND_PAGE_SIZE - 1) / REWIND_PAGE_SIZE;
+}
+
+RewindBuffer::RewindBuffer(size_t memory_limit)
+    : m_memory_limit(memory_limit), m_wrkmem(LZO1X_1_MEM_COMPRESS)
+{
+}
+
+// A page which doesn't get smaller is stored as is, which is told apart by its size.
+std::shared_ptr<const RewindBuffer::Page> RewindBuffer::CompressPage(const u8* data,
+                                                                     size_t length)
+{
+  Page compressed(length + length / 16 + 64 + 3);
+  lzo_uint out_len = 0;
+  if (lzo1x_1_compress(data, length, compressed.data(), &out_len, m_wrkmem.data()) != LZO_E_OK ||
+      out_len >= length)
+  {
+    std::copy(data, data + length, compressed.begin());
+    out_len = length;
+  }
+  compressed.resize(out_len);
+  compressed.shrink_to_fit();
+
+  m_memory_usage += out_len;
+  return std::shared_ptr<const Page>(new Page(std::move(compressed)), [this](const Page* page) {
+    m_memory_usage -= page->size();
+    delete page;
+  });
+}
+
+void RewindBuffer::DecompressSnapshot(const Snapshot& snapshot, std::vector<u8>* state) const
+{
+  state->resize(snapshot.size);
+
+  size_t page_index = 0;
+  for (const PointerWrap::LargeArray& segment : snapshot.segments)
+  {
+    for (size_t offset = 0; offset < segment.size; offset += REWIND_PAGE_SIZE)
+    {
+      const size_t length = std::min(REWIND_PAGE_SIZE, segment.size - offset);
+      const Page& page = *snapshot.pages[page_index++];
+      u8* const dest = state->data() + segment.offset + offset;
+
+      lzo_uint new_len = length;
+      if (page.size() == length)
+        std::memcpy(dest, page.data(), length);
+      else
+        lzo1x_decompress_safe(page.data(), page.size(), dest, &new_len, nullptr);
+      _assert_(new_len == length);
+    }
+  }
+}
+
+std::vector<u8> RewindBuffer::Push(RecordedState state)
+{
+  Snapshot snapshot;
+  snapshot.size = state.buffer.size();
+  snapshot.segments = GetSegments(state);
+
+  size_t previous_page_start = 0;
+  for (size_t i = 0; i < snapshot.segments.size(); ++i)
+  {
+    const PointerWrap::LargeArray& segment = snapshot.segments[i];
+
+    // Pages can only be shared within segments which line up with the previous snapshot.
+    const PointerWrap::LargeArray* previous_segment = nullptr;
+    if (i < m_previous.segments.size() && m_previous.segments[i].size == segment.size)
+      previous_segment = &m_previous.segments[i];
+
+    for (size_t offset = 0; offset < segment.size; offset += REWIND_PAGE_SIZE)
+    {
+      const size_t length = std::min(REWIND_PAGE_SIZE, segment.size - offset);
+      const u8* const data = &state.buffer[segment.offset + offset];
+      if (previous_segment &&
+          !std::memcmp(data, &m_previous_buffer[previous_segment->offset + offset], length))
+      {
+        const size_t previous_page_index = previous_page_start + offset / REWIND_PAGE_SIZE;
+        snapshot.pages.push_back(m_previous.pages[previous_page_index]);
+      }
+      else
+      {
+        snapshot.pages.push_back(CompressPage(data, length));
+      }
+    }
+
+    if (i < m_previous.segments.size())
+      previous_page_start += GetPageCount(m_previous.segments[i].size);
+  }
+
+  m_snapshots.push_back(snapshot);
+  m_previous = std::move(snapshot);
+  m_previous_buffer.swap(state.buffer);
+  m_previous_is_newest = true;
+
+  while (m_memory_usage > m_memory_limit && m_snapshots.size() > 1)
+    m_snapshots.pop_front();
+
+  return std::move(state.buffer);
+}
+
+bool RewindBuffer::Pop(std::vector<u8>* state)
+{
+  if (m_snapshots.empty())
+    return false;
+
+  if (m_previous_is_newest)
+  {
+    *state = m_previous_buffer;
+  }
+  else
+  {
+    m_previous = m_snapshots.back();
+    DecompressSnapshot(m_previous, state);
+    m_previous_buffer = *state;
+  }
+
+  m_snapshots.pop_back();
+  m_previous_is_newest = false;
+  return true;
+}
+
+void RewindBuffer::Clear()
+{
+  m_snapshots.clear();
+  m_previous = {};
+  m_previous_buffer = {};
+  m_previous_is_newest = false;
+}
+}
@@ -0,0 +1,66 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// In-memory ring of recent savestates for rewinding.
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+#include "Core/StateDelta.h"
+
+namespace State
+{
+// Keeps compressed snapshots within a fixed amount of memory, dropping the oldest ones.
+// The uncompressed copy of the previous snapshot comes on top of that.
+// A snapshot is split into pages, and a page which didn't change since the previous snapshot
+// is shared with it instead of being compressed again.
+class RewindBuffer
+{
+public:
+  explicit RewindBuffer(size_t memory_limit);
+
+  // Returns the buffer of the snapshot before, which isn't needed anymore, so that it
+  // can be reused for capturing the next one.
+  std::vector<u8> Push(RecordedState state);
+  // Removes the newest snapshot. Stepping back past it will return the one before.
+  bool Pop(std::vector<u8>* state);
+  void Clear();
+
+  size_t GetSnapshotCount() const { return m_snapshots.size(); }
+  size_t GetMemoryUsage() const { return m_memory_usage; }
+
+private:
+  using Page = std::vector<u8>;
+
+  struct Snapshot
+  {
+    size_t size;
+    std::vector<PointerWrap::LargeArray> segments;
+    std::vector<std::shared_ptr<const Page>> pages;
+  };
+
+  std::shared_ptr<const Page> CompressPage(const u8* data, size_t length);
+  void DecompressSnapshot(const Snapshot& snapshot, std::vector<u8>* state) const;
+
+  // Declared first so that it outlives the pages, which update it when they are freed.
+  size_t m_memory_usage = 0;
+  size_t m_memory_limit;
+
+  std::deque<Snapshot> m_snapshots;
+
+  // The newest snapshot, or the one returned by the last Pop, which the next snapshot is
+  // compared against. It is kept uncompressed so that stepping back to it is instant.
+  Snapshot m_previous;
+  std::vector<u8> m_previous_buffer;
+  bool m_previous_is_newest = false;
+
+  std::vector<u8> m_wrkmem;
+};
+}
@@ -8,6 +8,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "Common/CDUtils.h"
 #include "Common/CommonTypes.h"
@@ -16,6 +17,7 @@
 #include "DiscIO/Blob.h"
 #include "DiscIO/CISOBlob.h"
 #include "DiscIO/CompressedBlob.h"
+#include "DiscIO/DCZBlob.h"
 #include "DiscIO/DirectoryBlob.h"
 #include "DiscIO/DriveBlob.h"
 #include "DiscIO/FileBlob.h"
@@ -24,106 +26,91 @@
 
 namespace DiscIO
 {
-void SectorReader::SetSectorSize(int blocksize)
-{
-  m_block_size = std::max(blocksize, 0);
-  for (auto& cache_entry : m_cache)
-  {
-    cache_entry.Reset();
-    cache_entry.data.resize(m_chunk_blocks * m_block_size);
-  }
-}
-
-void SectorReader::SetChunkSize(int block_cnt)
+SectorReader::SectorReader()
+    : m_cache(BlockCache::GetShared()), m_cache_owner(BlockCache::NewOwnerID())
 {
-  m_chunk_blocks = std::max(block_cnt, 1);
-  // Clear cache and resize the data arrays
-  SetSectorSize(m_block_size);
 }
 
 SectorReader::~SectorReader()
 {
+  m_cache.Erase(m_cache_owner);
 }
 
-const SectorReader::Cache* SectorReader::FindCacheLine(u64 block_num)
+void SectorReader::SetSectorSize(int blocksize)
 {
-  auto itr = std::find_if(m_cache.begin(), m_cache.end(),
-                          [&](const Cache& entry) { return entry.Contains(block_num); });
-  if (itr == m_cache.end())
-    return nullptr;
-
-  itr->MarkUsed();
-  return &*itr;
+  m_block_size = std::max(blocksize, 0);
+  m_cache.Erase(m_cache_owner);
 }
 
-SectorReader::Cache* SectorReader::GetEmptyCacheLine()
+void SectorReader::SetChunkSize(int block_cnt)
 {
-  Cache* oldest = &m_cache[0];
-  // Find the Least Recently Used cache line to replace.
-  std::for_each(m_cache.begin() + 1, m_cache.end(), [&](Cache& line) {
-    if (line.IsLessRecentlyUsedThan(*oldest))
-    {
-      oldest->ShiftLRU();
-      oldest = &line;
-      return;
-    }
-    line.ShiftLRU();
-  });
-  oldest->Reset();
-  return oldest;
+  m_chunk_blocks = std::max(block_cnt, 1);
+  m_cache.Erase(m_cache_owner);
 }
 
-const SectorReader::Cache* SectorReader::GetCacheLine(u64 block_num)
+bool SectorReader::Read(u64 offset, u64 size, u8* out_ptr)
 {
-  if (auto entry = FindCacheLine(block_num))
-    return entry;
-
-  // Cache miss. Fault in the missing entry.
-  Cache* cache = GetEmptyCacheLine();
-  // We only read aligned chunks, this avoids duplicate overlapping entries.
-  u64 chunk_idx = block_num / m_chunk_blocks;
-  u32 blocks_read = ReadChunk(cache->data.data(), chunk_idx);
-  if (!blocks_read)
-    return nullptr;
-  cache->Fill(chunk_idx * m_chunk_blocks, blocks_read);
+  if (size == 0)
+    return true;
 
-  // Secondary check for out-of-bounds read.
-  // If we got less than m_chunk_blocks, we may still have missed.
-  // We do this after the cache fill since the cache line itself is
-  // fine, the problem is being asked to read past the end of the disk.
-  return cache->Contains(block_num) ? cache : nullptr;
-}
+  const u64 chunk_size = static_cast<u64>(m_block_size) * m_chunk_blocks;
+  const u64 last_chunk = (offset + size - 1) / chunk_size;
+  u64 chunk_num = offset / chunk_size;
 
-bool SectorReader::Read(u64 offset, u64 size, u8* out_ptr)
-{
-  u64 remain = size;
-  u64 block = 0;
-  u32 position_in_block = static_cast<u32>(offset % m_block_size);
+  // Chunks which were read together and haven't been copied out yet. They're kept here
+  // rather than looked up again, since a large read may push them out of the cache.
+  std::vector<BlockCache::Chunk> batch;
+  size_t batch_pos = 0;
 
-  while (remain > 0)
+  while (size > 0)
   {
-    block = offset / m_block_size;
+    BlockCache::Chunk chunk;
+    if (batch_pos < batch.size())
+      chunk = std::move(batch[batch_pos++]);
+    else
+      chunk = m_cache.Find(m_cache_owner, chunk_num);
 
-    const Cache* cache = GetCacheLine(block);
-    if (!cache)
-      return false;
+    if (!chunk)
+    {
+      batch = ReadChunks(chunk_num, CountMissingChunks(chunk_num, last_chunk));
+      if (batch.empty())
+        return false;
+      chunk = std::move(batch[0]);
+      batch_pos = 1;
+    }
 
     // Cache entries are aligned chunks, we may not want to read from the start
-    u32 read_offset = static_cast<u32>(block - cache->block_idx) * m_block_size + position_in_block;
-    u32 can_read = m_block_size * cache->num_blocks - read_offset;
-    u32 was_read = static_cast<u32>(std::min<u64>(can_read, remain));
+    const u64 read_offset = offset % chunk_size;
+    const u64 was_read = std::min(size, chunk_size - read_offset);
 
-    std::copy(cache->data.begin() + read_offset, cache->data.begin() + read_offset + was_read,
-              out_ptr);
+    // The last chunk of the disk may be short. Reading past its end fails.
+    if (read_offset + was_read > chunk->size())
+      return false;
+
+    std::copy_n(chunk->data() + read_offset, was_read, out_ptr);
 
     offset += was_read;
     out_ptr += was_read;
-    remain -= was_read;
-    position_in_block = 0;
+    size -= was_read;
+    chunk_num++;
   }
   return true;
 }
 
+u64 SectorReader::CountMissingChunks(u64 first_chunk, u64 last_chunk) const
+{
+  const u64 chunk_size = static_cast<u64>(m_block_size) * m_chunk_blocks;
+  const u64 max_chunks = std::max<u64>(MAX_BATCH_SIZE / chunk_size, 1);
+
+  u64 num_chunks = 1;
+  while (num_chunks < max_chunks && first_chunk + num_chunks <= last_chunk &&
+         !m_cache.Contains(m_cache_owner, first_chunk + num_chunks))
+  {
+    num_chunks++;
+  }
+  return num_chunks;
+}
+
 // Crap default implementation if not overridden.
 bool SectorReader::ReadMultipleAlignedBlocks(u64 block_num, u64 cnt_blocks, u8* out_ptr)
 {
@@ -136,42 +123,62 @@ bool SectorReader::ReadMultipleAlignedBlocks(u64 block_num, u64 cnt_blocks, u8*
   return true;
 }
 
-u32 SectorReader::ReadChunk(u8* buffer, u64 chunk_num)
+std::vector<BlockCache::Chunk> SectorReader::ReadChunks(u64 first_chunk, u64 num_chunks)
 {
-  u64 block_num = chunk_num * m_chunk_blocks;
-  u32 cnt_blocks = m_chunk_blocks;
+  const u64 block_num = first_chunk * m_chunk_blocks;
+  u64 cnt_blocks = num_chunks * m_chunk_blocks;
 
   // If we are reading the end of a disk, there may not be enough blocks to
-  // read a whole chunk. We need to clamp down in that case.
-  u64 end_block = (GetDataSize() + m_block_size - 1) / m_block_size;
+  // read whole chunks. We need to clamp down in that case.
+  const u64 end_block = (GetDataSize() + m_block_size - 1) / m_block_size;
   if (end_block)
-    cnt_blocks = static_cast<u32>(std::min<u64>(m_chunk_blocks, end_block - block_num));
+  {
+    if (block_num >= end_block)
+      return {};
+    cnt_blocks = std::min(cnt_blocks, end_block - block_num);
+  }
 
-  if (ReadMultipleAlignedBlocks(block_num, cnt_blocks, buffer))
+  std::vector<u8> buffer(cnt_blocks * m_block_size);
+  u64 blocks_read = cnt_blocks;
+  if (!ReadMultipleAlignedBlocks(block_num, cnt_blocks, buffer.data()))
   {
-    if (cnt_blocks < m_chunk_blocks)
+    // end_block may be zero on real disks if we fail to get the media size.
+    // We have to fallback to probing the disk instead.
+    if (end_block)
+      return {};
+
+    blocks_read = 0;
+    while (blocks_read < cnt_blocks &&
+           GetBlock(block_num + blocks_read, &buffer[blocks_read * m_block_size]))
     {
-      std::fill(buffer + cnt_blocks * m_block_size, buffer + m_chunk_blocks * m_block_size, 0u);
+      blocks_read++;
     }
-    return cnt_blocks;
   }
 
-  // end_block may be zero on real disks if we fail to get the media size.
-  // We have to fallback to probing the disk instead.
-  if (!end_block)
+  std::vector<BlockCache::Chunk> chunks;
+  if (blocks_read <= m_chunk_blocks)
   {
-    for (u32 i = 0; i < cnt_blocks; ++i)
+    // Only one chunk, so there's no need to copy it.
+    if (blocks_read)
     {
-      if (!GetBlock(block_num + i, buffer))
-      {
-        std::fill(buffer, buffer + (cnt_blocks - i) * m_block_size, 0u);
-        return i;
-      }
-      buffer += m_block_size;
+      buffer.resize(blocks_read * m_block_size);
+      chunks.push_back(std::make_shared<const std::vector<u8>>(std::move(buffer)));
     }
-    return cnt_blocks;
   }
-  return 0;
+  else
+  {
+    for (u64 first_block = 0; first_block < blocks_read; first_block += m_chunk_blocks)
+    {
+      const u64 chunk_blocks = std::min<u64>(m_chunk_blocks, blocks_read - first_block);
+      const auto begin = buffer.begin() + first_block * m_block_size;
+      chunks.push_back(std::make_shared<const std::vector<u8>>(
+          begin, begin + chunk_blocks * m_block_size));
+    }
+  }
+
+  for (size_t i = 0; i < chunks.size(); i++)
+    m_cache.Insert(m_cache_owner, first_chunk + i, chunks[i]);
+  return chunks;
 }
 
 std::unique_ptr<BlobReader> CreateBlobReader(const std::string& filename)
@@ -196,6 +203,8 @@ std::unique_ptr<BlobReader> CreateBlobReader(const std::string& filename)
   {
   case CISO_MAGIC:
     return CISOFileReader::Create(std::move(file));
+  case DCZ_MAGIC:
+    return DCZFileReader::Create(std::move(file), filename);
   case GCZ_MAGIC:
     return CompressedBlobReader::Create(std::move(file), filename);
   case TGC_MAGIC:
@@ -22,6 +22,7 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/Swap.h"
+#include "DiscIO/BlockCache.h"
 
 namespace DiscIO
 {
@@ -34,7 +35,8 @@ enum class BlobType
   GCZ,
   CISO,
   WBFS,
-  TGC
+  TGC,
+  DCZ
 };
 
 class BlobReader
@@ -68,6 +70,8 @@ protected:
 
 // Provides caching and byte-operation-to-block-operations facilities.
 // Used for compressed blob and direct drive reading.
+// Chunks are kept in the shared BlockCache, and reads which miss several chunks in a row
+// load them with a single ReadMultipleAlignedBlocks call.
 // NOTE: GetDataSize() is expected to be evenly divisible by the sector size.
 class SectorReader : public BlobReader
 {
@@ -77,6 +81,8 @@ public:
   bool Read(u64 offset, u64 size, u8* out_ptr) override;
 
 protected:
+  SectorReader();
+
   void SetSectorSize(int blocksize);
   int GetSectorSize() const { return m_block_size; }
   // Set the chunk size -> the number of blocks to read at a time.
@@ -95,63 +101,22 @@ protected:
   virtual bool ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8* out_ptr);
 
 private:
-  struct Cache
-  {
-    std::vector<u8> data;
-    u64 block_idx = 0;
-    u32 num_blocks = 0;
-
-    // [Pseudo-] Least Recently Used Shift Register
-    // When an empty cache line is needed, the line with the lowest value
-    // is taken and reset; the LRU register is then shifted down 1 place
-    // on all lines (low bit discarded). When a line is used, the high bit
-    // is set marking it as most recently used.
-    u32 lru_sreg = 0;
-
-    void Reset()
-    {
-      block_idx = 0;
-      num_blocks = 0;
-      lru_sreg = 0;
-    }
-    void Fill(u64 block, u32 count)
-    {
-      block_idx = block;
-      num_blocks = count;
-      // NOTE: Setting only the high bit means the newest line will
-      //   be selected for eviction if every line in the cache was
-      //   touched. This gives MRU behavior which is probably
-      //   desirable in that case.
-      MarkUsed();
-    }
-    bool Contains(u64 block) const { return block >= block_idx && block - block_idx < num_blocks; }
-    void MarkUsed() { lru_sreg |= 0x80000000; }
-    void ShiftLRU() { lru_sreg >>= 1; }
-    bool IsLessRecentlyUsedThan(const Cache& other) const { return lru_sreg < other.lru_sreg; }
-  };
-
-  // Gets the cache line that contains the given block, or nullptr.
-  // NOTE: The cache record only lasts until it expires (next GetEmptyCacheLine)
-  const Cache* FindCacheLine(u64 block_num);
-
-  // Finds the least recently used cache line, resets and returns it.
-  Cache* GetEmptyCacheLine();
-
-  // Combines FindCacheLine with GetEmptyCacheLine and ReadChunk.
-  // Always returns a valid cache line (loading the data if needed).
-  // May return nullptr only if the cache missed and the read failed.
-  const Cache* GetCacheLine(u64 block_num);
-
-  // Read all bytes from a chunk of blocks into a buffer.
-  // Returns the number of blocks read (may be less than m_chunk_blocks
-  // if chunk_num is the last chunk on the disk and the disk size is not
-  // evenly divisible into chunks). Returns zero if it fails.
-  u32 ReadChunk(u8* buffer, u64 chunk_num);
-
-  static constexpr int CACHE_LINES = 32;
+  // Reads up to MAX_BATCH_SIZE bytes worth of missing chunks at a time.
+  static constexpr u64 MAX_BATCH_SIZE = 0x100000;
+
+  // The number of chunks from first_chunk up to last_chunk which aren't cached,
+  // stopping at the first chunk which is.
+  u64 CountMissingChunks(u64 first_chunk, u64 last_chunk) const;
+
+  // Reads a run of chunks and adds them to the cache. The result may have fewer
+  // chunks than requested (or a shorter last chunk) at the end of the disk,
+  // and is empty if the read fails.
+  std::vector<BlockCache::Chunk> ReadChunks(u64 first_chunk, u64 num_chunks);
+
   u32 m_block_size = 0;    // Bytes in a sector/block
   u32 m_chunk_blocks = 1;  // Number of sectors/blocks in a chunk
-  std::array<Cache, CACHE_LINES> m_cache;
+  BlockCache& m_cache;
+  const u64 m_cache_owner;
 };
 
 // Factory function - examines the path to choose the right type of BlobReader, and returns one.
@@ -162,6 +127,8 @@ typedef bool (*CompressCB)(const std::string& text, float percent, void* arg);
 bool CompressFileToBlob(const std::string& infile_path, const std::string& outfile_path,
                         u32 sub_type = 0, int sector_size = 16384, CompressCB callback = nullptr,
                         void* arg = nullptr);
+bool ConvertToDCZ(const std::string& infile_path, const std::string& outfile_path,
+                  CompressCB callback = nullptr, void* arg = nullptr);
 bool DecompressBlobToFile(const std::string& infile_path, const std::string& outfile_path,
                           CompressCB callback = nullptr, void* arg = nullptr);
 
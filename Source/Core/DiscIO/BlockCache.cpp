@@ -0,0 +1,115 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DiscIO/BlockCache.h"
+
+#include <atomic>
+#include <utility>
+
+namespace DiscIO
+{
+BlockCache::BlockCache(size_t capacity) : m_capacity(capacity)
+{
+}
+
+BlockCache& BlockCache::GetShared()
+{
+  static BlockCache cache(DEFAULT_CAPACITY);
+  return cache;
+}
+
+u64 BlockCache::NewOwnerID()
+{
+  static std::atomic<u64> s_next_owner{0};
+  return s_next_owner++;
+}
+
+size_t BlockCache::GetCapacity() const
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_capacity;
+}
+
+void BlockCache::SetCapacity(size_t capacity)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_capacity = capacity;
+  EvictUntil(m_capacity);
+}
+
+size_t BlockCache::GetSize() const
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_size;
+}
+
+BlockCache::Chunk BlockCache::Find(u64 owner, u64 index)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  const auto it = m_index.find({owner, index});
+  if (it == m_index.end())
+    return nullptr;
+
+  m_entries.splice(m_entries.begin(), m_entries, it->second);
+  return it->second->chunk;
+}
+
+bool BlockCache::Contains(u64 owner, u64 index) const
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_index.count({owner, index}) != 0;
+}
+
+void BlockCache::Insert(u64 owner, u64 index, Chunk chunk)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  const Key key{owner, index};
+  const auto it = m_index.find(key);
+  if (it != m_index.end())
+  {
+    m_size -= it->second->chunk->size();
+    m_entries.erase(it->second);
+    m_index.erase(it);
+  }
+
+  // A chunk which doesn't fit at all is only kept by the caller.
+  if (chunk->size() > m_capacity)
+    return;
+
+  EvictUntil(m_capacity - chunk->size());
+  m_size += chunk->size();
+  m_entries.push_front({key, std::move(chunk)});
+  m_index.emplace(key, m_entries.begin());
+}
+
+void BlockCache::Erase(u64 owner)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  for (auto it = m_entries.begin(); it != m_entries.end();)
+  {
+    if (it->key.owner == owner)
+    {
+      m_size -= it->chunk->size();
+      m_index.erase(it->key);
+      it = m_entries.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void BlockCache::EvictUntil(size_t size)
+{
+  while (m_size > size)
+  {
+    const Entry& entry = m_entries.back();
+    m_size -= entry.chunk->size();
+    m_index.erase(entry.key);
+    m_entries.pop_back();
+  }
+}
+
+}  // namespace
@@ -0,0 +1,82 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace DiscIO
+{
+// A memory-bounded cache of decoded chunks, keyed by the reader they belong to and their index.
+// Several readers can share one cache, and it can be used from several threads. Once the cache
+// is full, the least recently used chunks are evicted. A chunk that has been returned stays
+// valid for as long as the caller holds on to it, even if it gets evicted in the meantime.
+class BlockCache
+{
+public:
+  using Chunk = std::shared_ptr<const std::vector<u8>>;
+
+  static constexpr size_t DEFAULT_CAPACITY = 16 * 1024 * 1024;
+
+  explicit BlockCache(size_t capacity);
+
+  // The cache which all SectorReaders use.
+  static BlockCache& GetShared();
+  // Every reader needs an ID of its own to store its chunks under.
+  static u64 NewOwnerID();
+
+  size_t GetCapacity() const;
+  void SetCapacity(size_t capacity);
+  size_t GetSize() const;
+
+  Chunk Find(u64 owner, u64 index);
+  bool Contains(u64 owner, u64 index) const;
+  void Insert(u64 owner, u64 index, Chunk chunk);
+  // Removes all chunks of a reader, e.g. when it's destroyed.
+  void Erase(u64 owner);
+
+private:
+  struct Key
+  {
+    u64 owner;
+    u64 index;
+
+    bool operator==(const Key& other) const
+    {
+      return owner == other.owner && index == other.index;
+    }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const
+    {
+      return std::hash<u64>()(key.owner * 0x9E3779B97F4A7C15ULL ^ key.index);
+    }
+  };
+
+  struct Entry
+  {
+    Key key;
+    Chunk chunk;
+  };
+
+  void EvictUntil(size_t size);
+
+  mutable std::mutex m_mutex;
+  size_t m_capacity;
+  size_t m_size = 0;
+  // Most recently used first
+  std::list<Entry> m_entries;
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+};
+
+}  // namespace
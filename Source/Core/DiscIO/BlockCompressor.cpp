@@ -0,0 +1,121 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DiscIO/BlockCompressor.h"
+
+#include <zlib.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Common/Thread.h"
+
+namespace DiscIO
+{
+namespace
+{
+bool Compress(z_stream* z, u32 block_size, CompressionSlot* slot)
+{
+  if (deflateReset(z) != Z_OK)
+  {
+    ERROR_LOG(DISCIO, "Deflate failed");
+    return false;
+  }
+
+  z->next_in = slot->in_buf.data();
+  z->avail_in = block_size;
+  z->next_out = slot->out_buf.data();
+  z->avail_out = block_size;
+
+  int status = deflate(z, Z_FINISH);
+  if ((status != Z_STREAM_END) || (z->avail_out < 10))
+  {
+    // let's store uncompressed
+    slot->result = slot->in_buf.data();
+    slot->result_size = block_size;
+    slot->stored = true;
+  }
+  else
+  {
+    // let's store compressed
+    slot->result = slot->out_buf.data();
+    slot->result_size = block_size - z->avail_out;
+    slot->stored = false;
+  }
+
+  slot->hash = HashAdler32(slot->result, slot->result_size);
+  return true;
+}
+}  // Anonymous namespace
+
+BlockCompressor::BlockCompressor(u32 block_size, u32 num_threads) : m_block_size(block_size)
+{
+  // Keep enough blocks in flight that the workers don't run dry while a block is written.
+  m_slots.resize(num_threads * 2);
+  for (CompressionSlot& slot : m_slots)
+  {
+    slot.in_buf.resize(block_size);
+    slot.out_buf.resize(block_size);
+  }
+
+  for (u32 i = 0; i < num_threads; i++)
+    m_threads.emplace_back(&BlockCompressor::WorkerThread, this);
+}
+
+BlockCompressor::~BlockCompressor()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_exit = true;
+  }
+  m_work_available.notify_all();
+  for (std::thread& thread : m_threads)
+    thread.join();
+}
+
+void BlockCompressor::Submit(CompressionSlot* slot)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    slot->done = false;
+    m_queue.push(slot);
+  }
+  m_work_available.notify_one();
+}
+
+void BlockCompressor::WaitFor(const CompressionSlot& slot)
+{
+  std::unique_lock<std::mutex> lk(m_mutex);
+  m_work_done.wait(lk, [&slot] { return slot.done; });
+}
+
+void BlockCompressor::WorkerThread()
+{
+  Common::SetCurrentThreadName("Disc compression");
+
+  z_stream z = {};
+  const bool initialized = deflateInit(&z, 9) == Z_OK;
+
+  std::unique_lock<std::mutex> lk(m_mutex);
+  while (true)
+  {
+    m_work_available.wait(lk, [this] { return m_exit || !m_queue.empty(); });
+    if (m_queue.empty())
+      break;
+    CompressionSlot* slot = m_queue.front();
+    m_queue.pop();
+    lk.unlock();
+
+    slot->failed = !initialized || !Compress(&z, m_block_size, slot);
+
+    lk.lock();
+    slot->done = true;
+    m_work_done.notify_all();
+  }
+
+  if (initialized)
+    deflateEnd(&z);
+}
+
+}  // namespace
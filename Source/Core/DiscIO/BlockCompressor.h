@@ -0,0 +1,59 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace DiscIO
+{
+// A block which is being compressed. The buffers are reused for later blocks.
+struct CompressionSlot
+{
+  std::vector<u8> in_buf;
+  std::vector<u8> out_buf;
+  const u8* result = nullptr;
+  u32 result_size = 0;
+  bool stored = false;
+  bool failed = false;
+  u32 hash = 0;
+  bool done = true;
+};
+
+// Deflates blocks on worker threads. Blocks are handed out and collected in the same order, so
+// the output is identical to compressing them one by one. A block which doesn't get smaller is
+// stored as is. The hash is the Adler-32 of the result.
+class BlockCompressor
+{
+public:
+  BlockCompressor(u32 block_size, u32 num_threads);
+  ~BlockCompressor();
+
+  size_t GetNumSlots() const { return m_slots.size(); }
+  // The slot which block_index is read into. It has to be collected before it can be reused.
+  CompressionSlot& GetSlot(u32 block_index) { return m_slots[block_index % m_slots.size()]; }
+  void Submit(CompressionSlot* slot);
+  void WaitFor(const CompressionSlot& slot);
+
+private:
+  void WorkerThread();
+
+  const u32 m_block_size;
+  std::vector<CompressionSlot> m_slots;
+  std::vector<std::thread> m_threads;
+
+  std::mutex m_mutex;
+  std::condition_variable m_work_available;
+  std::condition_variable m_work_done;
+  std::queue<CompressionSlot*> m_queue;
+  bool m_exit = false;
+};
+
+}  // namespace
@@ -0,0 +1,83 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DiscIO/BlockDecompressor.h"
+
+#include <algorithm>
+
+#include "Common/CommonTypes.h"
+#include "Common/Thread.h"
+
+namespace DiscIO
+{
+BlockDecompressor::BlockDecompressor(u32 num_threads)
+{
+  for (u32 i = 0; i < num_threads; i++)
+    m_threads.emplace_back(&BlockDecompressor::WorkerThread, this);
+}
+
+BlockDecompressor::~BlockDecompressor()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_exit = true;
+  }
+  m_work_available.notify_all();
+  for (std::thread& thread : m_threads)
+    thread.join();
+}
+
+BlockDecompressor& BlockDecompressor::GetShared()
+{
+  static BlockDecompressor decompressor(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+  return decompressor;
+}
+
+void BlockDecompressor::Run(u64 num_tasks, const std::function<void(u64)>& task)
+{
+  std::lock_guard<std::mutex> run_lk(m_run_mutex);
+
+  std::unique_lock<std::mutex> lk(m_mutex);
+  m_task = &task;
+  m_num_tasks = num_tasks;
+  m_next_task = 0;
+  m_pending_tasks = num_tasks;
+  if (num_tasks > 1)
+    m_work_available.notify_all();
+
+  while (m_next_task < m_num_tasks)
+  {
+    const u64 index = m_next_task++;
+    lk.unlock();
+    task(index);
+    lk.lock();
+    m_pending_tasks--;
+  }
+
+  m_work_done.wait(lk, [this] { return m_pending_tasks == 0; });
+  m_task = nullptr;
+}
+
+void BlockDecompressor::WorkerThread()
+{
+  Common::SetCurrentThreadName("Disc decompression");
+
+  std::unique_lock<std::mutex> lk(m_mutex);
+  while (true)
+  {
+    m_work_available.wait(lk, [this] { return m_exit || m_next_task < m_num_tasks; });
+    if (m_exit)
+      break;
+    const u64 index = m_next_task++;
+    lk.unlock();
+
+    (*m_task)(index);
+
+    lk.lock();
+    if (--m_pending_tasks == 0)
+      m_work_done.notify_all();
+  }
+}
+
+}  // namespace
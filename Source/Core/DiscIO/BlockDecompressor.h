@@ -0,0 +1,50 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace DiscIO
+{
+// Worker threads which blob readers split the decoding of a batch of blocks between. The threads
+// are started once and wait for work, so that short reads don't pay for starting threads.
+class BlockDecompressor
+{
+public:
+  explicit BlockDecompressor(u32 num_threads);
+  ~BlockDecompressor();
+
+  // The workers which all blob readers share. There is one less than there are host threads,
+  // since the thread calling Run helps out.
+  static BlockDecompressor& GetShared();
+
+  u32 GetNumThreads() const { return static_cast<u32>(m_threads.size()); }
+  // Calls task once for every index below num_tasks, on the workers and on the calling thread,
+  // and returns once all calls have returned. Batches from several threads run one at a time.
+  void Run(u64 num_tasks, const std::function<void(u64)>& task);
+
+private:
+  void WorkerThread();
+
+  std::vector<std::thread> m_threads;
+
+  std::mutex m_run_mutex;
+  std::mutex m_mutex;
+  std::condition_variable m_work_available;
+  std::condition_variable m_work_done;
+  const std::function<void(u64)>* m_task = nullptr;
+  u64 m_num_tasks = 0;
+  u64 m_next_task = 0;
+  u64 m_pending_tasks = 0;
+  bool m_exit = false;
+};
+
+}  // namespace
@@ -13,6 +13,7 @@
 #include <cstring>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 #include <zlib.h>
@@ -21,10 +22,11 @@
 #include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "Common/Hash.h"
-#include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
 #include "DiscIO/Blob.h"
+#include "DiscIO/BlockCompressor.h"
+#include "DiscIO/BlockDecompressor.h"
 #include "DiscIO/CompressedBlob.h"
 #include "DiscIO/DiscScrubber.h"
 
@@ -87,17 +89,8 @@ u64 CompressedBlobReader::GetBlockCompressedSize(u64 block_num) const
 
 bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 {
-  bool uncompressed = false;
   u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
-  u64 offset = m_block_pointers[block_num] + m_data_offset;
-
-  if (offset & (1ULL << 63))
-  {
-    if (comp_block_size != m_header.block_size)
-      PanicAlert("Uncompressed block with wrong size");
-    uncompressed = true;
-    offset &= ~(1ULL << 63);
-  }
+  u64 offset = (m_block_pointers[block_num] & ~(1ULL << 63)) + m_data_offset;
 
   // clear unused part of zlib buffer. maybe this can be deleted when it works fully.
   memset(&m_zlib_buffer[comp_block_size], 0, m_zlib_buffer.size() - comp_block_size);
@@ -111,8 +104,59 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
     return false;
   }
 
+  return DecodeBlock(block_num, m_zlib_buffer.data(), comp_block_size, out_ptr);
+}
+
+bool CompressedBlobReader::ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8* out_ptr)
+{
+  // The blocks are stored back to back, so they can be read from the file in one go.
+  std::vector<u64> stored_offsets(num_blocks + 1);
+  for (u64 i = 0; i < num_blocks; i++)
+    stored_offsets[i + 1] = stored_offsets[i] + (u32)GetBlockCompressedSize(block_num + i);
+
+  m_batch_buffer.resize(stored_offsets[num_blocks]);
+  m_file.Seek((m_block_pointers[block_num] & ~(1ULL << 63)) + m_data_offset, SEEK_SET);
+  if (!m_file.ReadBytes(m_batch_buffer.data(), m_batch_buffer.size()))
+  {
+    PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
+                m_file_name.c_str());
+    m_file.Clear();
+    return false;
+  }
+
+  // Decompressing is what takes time, so split the blocks between the shared workers
+  // when there are enough of them to be worth waking the workers for.
+  BlockDecompressor& decompressor = BlockDecompressor::GetShared();
+  const u64 num_tasks = std::max<u64>(std::min<u64>(decompressor.GetNumThreads() + 1,
+                                                    num_blocks / MIN_BLOCKS_PER_DECOMPRESSION_TASK),
+                                      1);
+  // Not std::vector<bool>, since its elements can't be written from several threads at once.
+  std::vector<char> results(num_tasks);
+  decompressor.Run(num_tasks, [&](u64 task_index) {
+    bool success = true;
+    for (u64 i = num_blocks * task_index / num_tasks; i < num_blocks * (task_index + 1) / num_tasks;
+         i++)
+    {
+      const u32 stored_size = static_cast<u32>(stored_offsets[i + 1] - stored_offsets[i]);
+      success &= DecodeBlock(block_num + i, &m_batch_buffer[stored_offsets[i]], stored_size,
+                             out_ptr + i * m_header.block_size);
+    }
+    results[task_index] = success;
+  });
+
+  return std::all_of(results.begin(), results.end(), [](char result) { return result != 0; });
+}
+
+// Only touches its arguments and constant members, so it can run on several threads at once.
+bool CompressedBlobReader::DecodeBlock(u64 block_num, const u8* stored, u32 comp_block_size,
+                                       u8* out_ptr) const
+{
+  const bool uncompressed = (m_block_pointers[block_num] & (1ULL << 63)) != 0;
+  if (uncompressed && comp_block_size != m_header.block_size)
+    PanicAlert("Uncompressed block with wrong size");
+
   // First, check hash.
-  u32 block_hash = HashAdler32(m_zlib_buffer.data(), comp_block_size);
+  u32 block_hash = HashAdler32(stored, comp_block_size);
   if (block_hash != m_hashes[block_num])
     PanicAlertT("The disc image \"%s\" is corrupt.\n"
                 "Hash of block %" PRIu64 " is %08x instead of %08x.",
@@ -120,12 +164,12 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 
   if (uncompressed)
   {
-    std::copy(m_zlib_buffer.begin(), m_zlib_buffer.begin() + comp_block_size, out_ptr);
+    std::copy(stored, stored + comp_block_size, out_ptr);
   }
   else
   {
     z_stream z = {};
-    z.next_in = m_zlib_buffer.data();
+    z.next_in = const_cast<u8*>(stored);
     z.avail_in = comp_block_size;
     if (z.avail_in > m_header.block_size)
     {
@@ -193,10 +237,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     scrubbing = true;
   }
 
-  z_stream z = {};
-  if (deflateInit(&z, 9) != Z_OK)
-    return false;
-
   callback(GetStringT("Files opened, ready to compress."), 0, arg);
 
   CompressedBlobHeader header;
@@ -210,8 +250,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
 
   std::vector<u64> offsets(header.num_blocks);
   std::vector<u32> hashes(header.num_blocks);
-  std::vector<u8> out_buf(block_size);
-  std::vector<u8> in_buf(block_size);
 
   // seek past the header (we will write it at the end)
   outfile.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
@@ -227,11 +265,47 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
   int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
   bool success = true;
 
-  for (u32 i = 0; i < header.num_blocks; i++)
+  // This thread reads the blocks and writes them out in order, while the compression, which takes
+  // up almost all of the time, runs on the other cores.
+  BlockCompressor compressor(block_size, std::max(std::thread::hardware_concurrency(), 1u));
+
+  // Writes the oldest block which is still in flight.
+  u32 num_written = 0;
+  auto write_next_block = [&] {
+    CompressionSlot& slot = compressor.GetSlot(num_written);
+    compressor.WaitFor(slot);
+    if (slot.failed)
+      return false;
+
+    if (!outfile.WriteBytes(slot.result, slot.result_size))
+    {
+      PanicAlertT("Failed to write the output file \"%s\".\n"
+                  "Check that you have enough space available on the target drive.",
+                  outfile_path.c_str());
+      return false;
+    }
+
+    offsets[num_written] = position;
+    if (slot.stored)
+    {
+      offsets[num_written] |= 0x8000000000000000ULL;
+      num_stored++;
+    }
+    else
+    {
+      num_compressed++;
+    }
+    hashes[num_written] = slot.hash;
+    position += slot.result_size;
+    num_written++;
+    return true;
+  };
+
+  for (u32 i = 0; i < header.num_blocks && success; i++)
   {
     if (i % progress_monitor == 0)
     {
-      const u64 inpos = infile.Tell();
+      const u64 inpos = static_cast<u64>(num_written) * block_size;
       int ratio = 0;
       if (inpos != 0)
         ratio = (int)(100 * position / inpos);
@@ -247,66 +321,27 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
       }
     }
 
-    offsets[i] = position;
-
-    size_t read_bytes;
-    if (scrubbing)
-      read_bytes = disc_scrubber.GetNextBlock(infile, in_buf.data());
-    else
-      infile.ReadArray(in_buf.data(), header.block_size, &read_bytes);
-    if (read_bytes < header.block_size)
-      std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
-
-    int retval = deflateReset(&z);
-    z.next_in = in_buf.data();
-    z.avail_in = header.block_size;
-    z.next_out = out_buf.data();
-    z.avail_out = block_size;
-
-    if (retval != Z_OK)
+    if (i >= compressor.GetNumSlots() && !write_next_block())
     {
-      ERROR_LOG(DISCIO, "Deflate failed");
       success = false;
       break;
     }
 
-    int status = deflate(&z, Z_FINISH);
-    int comp_size = block_size - z.avail_out;
-
-    u8* write_buf;
-    int write_size;
-    if ((status != Z_STREAM_END) || (z.avail_out < 10))
-    {
-      // PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-      // let's store uncompressed
-      write_buf = in_buf.data();
-      offsets[i] |= 0x8000000000000000ULL;
-      write_size = block_size;
-      num_stored++;
-    }
+    CompressionSlot& slot = compressor.GetSlot(i);
+    size_t read_bytes;
+    if (scrubbing)
+      read_bytes = disc_scrubber.GetNextBlock(infile, slot.in_buf.data());
     else
-    {
-      // let's store compressed
-      // PanicAlert("Comp %i to %i", block_size, comp_size);
-      write_buf = out_buf.data();
-      write_size = comp_size;
-      num_compressed++;
-    }
-
-    if (!outfile.WriteBytes(write_buf, write_size))
-    {
-      PanicAlertT("Failed to write the output file \"%s\".\n"
-                  "Check that you have enough space available on the target drive.",
-                  outfile_path.c_str());
-      success = false;
-      break;
-    }
-
-    position += write_size;
+      infile.ReadArray(slot.in_buf.data(), header.block_size, &read_bytes);
+    if (read_bytes < header.block_size)
+      std::fill(slot.in_buf.begin() + read_bytes, slot.in_buf.begin() + header.block_size, 0);
 
-    hashes[i] = HashAdler32(write_buf, write_size);
+    compressor.Submit(&slot);
   }
 
+  while (success && num_written < header.num_blocks)
+    success = write_next_block();
+
   header.compressed_data_size = position;
 
   if (!success)
@@ -324,9 +359,6 @@ bool CompressFileToBlob(const std::string& infile_path, const std::string& outfi
     outfile.WriteArray(hashes.data(), header.num_blocks);
   }
 
-  // Cleanup
-  deflateEnd(&z);
-
   if (success)
   {
     callback(GetStringT("Done compressing disc image."), 1.0f, arg);
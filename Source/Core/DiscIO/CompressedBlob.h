@@ -54,8 +54,14 @@ public:
   u64 GetBlockCompressedSize(u64 block_num) const;
   bool GetBlock(u64 block_num, u8* out_ptr) override;
 
+protected:
+  bool ReadMultipleAlignedBlocks(u64 block_num, u64 num_blocks, u8* out_ptr) override;
+
 private:
+  static constexpr u64 MIN_BLOCKS_PER_DECOMPRESSION_TASK = 8;
+
   CompressedBlobReader(File::IOFile file, const std::string& filename);
+  bool DecodeBlock(u64 block_num, const u8* stored, u32 comp_block_size, u8* out_ptr) const;
 
   CompressedBlobHeader m_header;
   std::vector<u64> m_block_pointers;
@@ -64,6 +70,7 @@ private:
   File::IOFile m_file;
   u64 m_file_size;
   std::vector<u8> m_zlib_buffer;
+  std::vector<u8> m_batch_buffer;
   std::string m_file_name;
 };
 
@@ -0,0 +1,543 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <mbedtls/aes.h>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <zlib.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Core/IOS/ES/Formats.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/BlockCompressor.h"
+#include "DiscIO/DCZBlob.h"
+#include "DiscIO/Enums.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeWii.h"
+
+namespace DiscIO
+{
+namespace
+{
+constexpr u32 DCZ_CHUNK_SIZE = 0x20000;
+
+constexpr u32 BLOCK_HEADER_SIZE = VolumeWii::BLOCK_HEADER_SIZE;
+constexpr u32 BLOCK_DATA_SIZE = VolumeWii::BLOCK_DATA_SIZE;
+constexpr u32 BLOCK_TOTAL_SIZE = VolumeWii::BLOCK_TOTAL_SIZE;
+
+// The data of a block is encrypted with the IV at 0x3D0 in the encrypted hash block.
+constexpr u32 BLOCK_IV_OFFSET = 0x3D0;
+
+// Where VolumeWii expects the data of a partition to start when reading a plain image.
+constexpr u64 PARTITION_DATA_OFFSET = 0x20000;
+
+bool IsStoredDecrypted(const DCZPartitionEntry& partition, u64 block_offset)
+{
+  return block_offset >= partition.data_offset &&
+         block_offset - partition.data_offset < partition.data_size;
+}
+
+void DecryptBlock(mbedtls_aes_context* key, u8* block)
+{
+  u8 iv[16];
+  std::copy_n(&block[BLOCK_IV_OFFSET], sizeof(iv), iv);
+  mbedtls_aes_crypt_cbc(key, MBEDTLS_AES_DECRYPT, BLOCK_DATA_SIZE, iv, &block[BLOCK_HEADER_SIZE],
+                        &block[BLOCK_HEADER_SIZE]);
+
+  std::fill(std::begin(iv), std::end(iv), 0);
+  mbedtls_aes_crypt_cbc(key, MBEDTLS_AES_DECRYPT, BLOCK_HEADER_SIZE, iv, block, block);
+}
+
+void EncryptBlock(mbedtls_aes_context* key, u8* block)
+{
+  u8 iv[16] = {};
+  mbedtls_aes_crypt_cbc(key, MBEDTLS_AES_ENCRYPT, BLOCK_HEADER_SIZE, iv, block, block);
+
+  std::copy_n(&block[BLOCK_IV_OFFSET], sizeof(iv), iv);
+  mbedtls_aes_crypt_cbc(key, MBEDTLS_AES_ENCRYPT, BLOCK_DATA_SIZE, iv, &block[BLOCK_HEADER_SIZE],
+                        &block[BLOCK_HEADER_SIZE]);
+}
+
+// Only the partitions with a valid ticket can be decrypted. The others are stored as is.
+std::vector<DCZPartitionEntry> GetDecryptablePartitions(const std::string& path, BlobReader* reader)
+{
+  std::vector<DCZPartitionEntry> partitions;
+  std::unique_ptr<Volume> volume = CreateVolumeFromFilename(path);
+  if (!volume || volume->GetVolumeType() != Platform::WII_DISC)
+    return partitions;
+
+  for (const Partition& partition : volume->GetPartitions())
+  {
+    const IOS::ES::TicketReader& ticket = volume->GetTicket(partition);
+    const std::optional<u32> data_offset = reader->ReadSwapped<u32>(partition.offset + 0x2b8);
+    const std::optional<u32> data_size = reader->ReadSwapped<u32>(partition.offset + 0x2bc);
+    if (!ticket.IsValid() || !data_offset || !data_size)
+      continue;
+
+    DCZPartitionEntry entry;
+    entry.partition_offset = partition.offset;
+    entry.data_offset = partition.offset + (static_cast<u64>(*data_offset) << 2);
+    if (entry.data_offset % BLOCK_TOTAL_SIZE != 0 || entry.data_offset >= reader->GetDataSize())
+      continue;
+
+    // Only whole blocks which are on the disc can be stored decrypted.
+    entry.data_size = std::min(static_cast<u64>(*data_size) << 2,
+                               reader->GetDataSize() - entry.data_offset);
+    entry.data_size -= entry.data_size % BLOCK_TOTAL_SIZE;
+    entry.title_key = ticket.GetTitleKey();
+    partitions.push_back(entry);
+  }
+
+  return partitions;
+}
+}  // Anonymous namespace
+
+DCZFileReader::DCZFileReader(File::IOFile file, const std::string& path)
+    : m_file(std::move(file)), m_path(path), m_file_size(m_file.GetSize())
+{
+}
+
+DCZFileReader::~DCZFileReader()
+{
+}
+
+std::unique_ptr<DCZFileReader> DCZFileReader::Create(File::IOFile file, const std::string& path)
+{
+  std::unique_ptr<DCZFileReader> reader(new DCZFileReader(std::move(file), path));
+  if (!reader->ReadHeader())
+    return nullptr;
+  return reader;
+}
+
+bool DCZFileReader::ReadHeader()
+{
+  if (!m_file.Seek(0, SEEK_SET) || !m_file.ReadArray(&m_header, 1))
+    return false;
+
+  if (m_header.magic != DCZ_MAGIC || m_header.version != DCZ_VERSION ||
+      m_header.codec != DCZCodec::Deflate || m_header.chunk_size == 0 ||
+      m_header.chunk_size % BLOCK_TOTAL_SIZE != 0 ||
+      m_header.num_chunks != (m_header.data_size + m_header.chunk_size - 1) / m_header.chunk_size)
+  {
+    return false;
+  }
+
+  std::vector<DCZPartitionEntry> partitions(m_header.num_partitions);
+  m_chunks.resize(m_header.num_chunks);
+  if (!m_file.ReadArray(partitions.data(), partitions.size()) ||
+      !m_file.ReadArray(m_chunks.data(), m_chunks.size()))
+  {
+    return false;
+  }
+
+  for (const DCZChunkEntry& chunk : m_chunks)
+  {
+    if (chunk.size > m_header.chunk_size)
+      return false;
+  }
+
+  for (const DCZPartitionEntry& entry : partitions)
+  {
+    if (entry.data_offset % BLOCK_TOTAL_SIZE != 0 || entry.data_size % BLOCK_TOTAL_SIZE != 0)
+      return false;
+
+    auto key = std::make_unique<mbedtls_aes_context>();
+    mbedtls_aes_setkey_enc(key.get(), entry.title_key.data(), 128);
+    m_partitions.push_back(Partition{entry, std::move(key)});
+  }
+
+  m_compressed_buffer.resize(m_header.chunk_size);
+  m_chunk_buffer.resize(m_header.chunk_size);
+  m_encrypted_block.resize(BLOCK_TOTAL_SIZE);
+  m_decrypted_block.resize(BLOCK_TOTAL_SIZE);
+  return true;
+}
+
+const u8* DCZFileReader::GetChunk(u64 chunk_index)
+{
+  if (m_cached_chunk == chunk_index)
+    return m_chunk_buffer.data();
+
+  m_cached_chunk = UINT64_MAX;
+  const DCZChunkEntry& chunk = m_chunks[chunk_index];
+  if (chunk.size == 0)
+  {
+    std::fill(m_chunk_buffer.begin(), m_chunk_buffer.end(), 0);
+    m_cached_chunk = chunk_index;
+    return m_chunk_buffer.data();
+  }
+
+  const bool stored = chunk.size == m_header.chunk_size;
+  u8* const buffer = stored ? m_chunk_buffer.data() : m_compressed_buffer.data();
+  if (!m_file.Seek(chunk.offset, SEEK_SET) || !m_file.ReadBytes(buffer, chunk.size))
+  {
+    PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
+                m_path.c_str());
+    m_file.Clear();
+    return nullptr;
+  }
+
+  const u32 hash = HashAdler32(buffer, chunk.size);
+  if (hash != chunk.hash)
+  {
+    PanicAlertT("The disc image \"%s\" is corrupt.\n"
+                "Hash of block %" PRIu64 " is %08x instead of %08x.",
+                m_path.c_str(), chunk_index, hash, chunk.hash);
+    return nullptr;
+  }
+
+  if (!stored)
+  {
+    z_stream z = {};
+    z.next_in = buffer;
+    z.avail_in = chunk.size;
+    z.next_out = m_chunk_buffer.data();
+    z.avail_out = m_header.chunk_size;
+    if (inflateInit(&z) != Z_OK)
+      return nullptr;
+    const bool success = inflate(&z, Z_FINISH) == Z_STREAM_END && z.avail_out == 0;
+    inflateEnd(&z);
+    if (!success)
+    {
+      PanicAlert("Failure reading block %" PRIu64 " of \"%s\".", chunk_index, m_path.c_str());
+      return nullptr;
+    }
+  }
+
+  m_cached_chunk = chunk_index;
+  return m_chunk_buffer.data();
+}
+
+bool DCZFileReader::ReadStored(u64 offset, u64 size, u8* out_ptr)
+{
+  while (size > 0)
+  {
+    const u64 chunk_index = offset / m_header.chunk_size;
+    const u32 offset_in_chunk = static_cast<u32>(offset % m_header.chunk_size);
+    if (chunk_index >= m_chunks.size())
+      return false;
+
+    const u8* chunk = GetChunk(chunk_index);
+    if (!chunk)
+      return false;
+
+    const u32 copy_size =
+        static_cast<u32>(std::min<u64>(size, m_header.chunk_size - offset_in_chunk));
+    std::copy_n(chunk + offset_in_chunk, copy_size, out_ptr);
+
+    offset += copy_size;
+    out_ptr += copy_size;
+    size -= copy_size;
+  }
+  return true;
+}
+
+const DCZFileReader::Partition* DCZFileReader::FindPartition(u64 block_offset) const
+{
+  for (const Partition& partition : m_partitions)
+  {
+    if (IsStoredDecrypted(partition.entry, block_offset))
+      return &partition;
+  }
+  return nullptr;
+}
+
+bool DCZFileReader::Read(u64 offset, u64 size, u8* out_ptr)
+{
+  while (size > 0)
+  {
+    const u32 offset_in_block = static_cast<u32>(offset % BLOCK_TOTAL_SIZE);
+    const u64 block_offset = offset - offset_in_block;
+    const u32 copy_size = static_cast<u32>(std::min<u64>(size, BLOCK_TOTAL_SIZE - offset_in_block));
+
+    const Partition* partition = FindPartition(block_offset);
+    if (!partition)
+    {
+      if (!ReadStored(offset, copy_size, out_ptr))
+        return false;
+    }
+    else
+    {
+      if (m_encrypted_block_offset != block_offset)
+      {
+        m_encrypted_block_offset = UINT64_MAX;
+        if (!ReadStored(block_offset, BLOCK_TOTAL_SIZE, m_encrypted_block.data()))
+          return false;
+        EncryptBlock(partition->key.get(), m_encrypted_block.data());
+        m_encrypted_block_offset = block_offset;
+      }
+      std::copy_n(&m_encrypted_block[offset_in_block], copy_size, out_ptr);
+    }
+
+    offset += copy_size;
+    out_ptr += copy_size;
+    size -= copy_size;
+  }
+  return true;
+}
+
+const DCZFileReader::RawPartition& DCZFileReader::GetRawPartition(u64 partition_offset,
+                                                                  const Partition* partition)
+{
+  const auto it = m_raw_partitions.find(partition_offset);
+  if (it != m_raw_partitions.end())
+    return it->second;
+
+  RawPartition raw_partition{partition_offset + PARTITION_DATA_OFFSET, nullptr};
+  if (partition)
+    raw_partition.data_offset = partition->entry.data_offset;
+
+  std::vector<u8> ticket_buffer(sizeof(IOS::ES::Ticket));
+  if (Read(partition_offset, ticket_buffer.size(), ticket_buffer.data()))
+  {
+    const IOS::ES::TicketReader ticket(std::move(ticket_buffer));
+    if (ticket.IsValid())
+    {
+      const std::array<u8, 16> title_key = ticket.GetTitleKey();
+      raw_partition.key = std::make_unique<mbedtls_aes_context>();
+      mbedtls_aes_setkey_dec(raw_partition.key.get(), title_key.data(), 128);
+    }
+  }
+
+  return m_raw_partitions.emplace(partition_offset, std::move(raw_partition)).first->second;
+}
+
+bool DCZFileReader::ReadRawDecrypted(u64 offset, u64 size, u8* out_ptr,
+                                     const RawPartition& partition)
+{
+  if (!partition.key)
+    return false;
+
+  const u64 block_offset = partition.data_offset + offset / BLOCK_DATA_SIZE * BLOCK_TOTAL_SIZE;
+  if (m_decrypted_block_offset != block_offset)
+  {
+    m_decrypted_block_offset = UINT64_MAX;
+    if (!Read(block_offset, BLOCK_TOTAL_SIZE, m_decrypted_block.data()))
+      return false;
+    DecryptBlock(partition.key.get(), m_decrypted_block.data());
+    m_decrypted_block_offset = block_offset;
+  }
+
+  std::copy_n(&m_decrypted_block[BLOCK_HEADER_SIZE + offset % BLOCK_DATA_SIZE], size, out_ptr);
+  return true;
+}
+
+bool DCZFileReader::ReadWiiDecrypted(u64 offset, u64 size, u8* out_ptr, u64 partition_offset)
+{
+  const auto it = std::find_if(m_partitions.begin(), m_partitions.end(),
+                               [partition_offset](const Partition& partition) {
+                                 return partition.entry.partition_offset == partition_offset;
+                               });
+  const Partition* partition = it != m_partitions.end() ? &*it : nullptr;
+
+  while (size > 0)
+  {
+    const u64 block = offset / BLOCK_DATA_SIZE;
+    const u32 offset_in_block = static_cast<u32>(offset % BLOCK_DATA_SIZE);
+    const u32 copy_size = static_cast<u32>(std::min<u64>(size, BLOCK_DATA_SIZE - offset_in_block));
+
+    if (partition && (block + 1) * BLOCK_TOTAL_SIZE <= partition->entry.data_size)
+    {
+      const u64 stored_offset = partition->entry.data_offset + block * BLOCK_TOTAL_SIZE +
+                                BLOCK_HEADER_SIZE + offset_in_block;
+      if (!ReadStored(stored_offset, copy_size, out_ptr))
+        return false;
+    }
+    else
+    {
+      // The partition couldn't be decrypted when the image was converted, or the read goes past
+      // the end of the data that was stored decrypted.
+      if (!ReadRawDecrypted(offset, copy_size, out_ptr,
+                            GetRawPartition(partition_offset, partition)))
+      {
+        return false;
+      }
+    }
+
+    offset += copy_size;
+    out_ptr += copy_size;
+    size -= copy_size;
+  }
+  return true;
+}
+
+bool ConvertToDCZ(const std::string& infile_path, const std::string& outfile_path,
+                  CompressCB callback, void* arg)
+{
+  std::unique_ptr<BlobReader> reader = CreateBlobReader(infile_path);
+  if (!reader)
+  {
+    PanicAlertT("Failed to open the input file \"%s\".", infile_path.c_str());
+    return false;
+  }
+
+  if (reader->GetBlobType() == BlobType::DCZ)
+  {
+    PanicAlertT("\"%s\" is already compressed! Cannot compress it further.", infile_path.c_str());
+    return false;
+  }
+
+  const std::vector<DCZPartitionEntry> partitions =
+      GetDecryptablePartitions(infile_path, reader.get());
+  std::vector<std::unique_ptr<mbedtls_aes_context>> keys;
+  for (const DCZPartitionEntry& partition : partitions)
+  {
+    keys.push_back(std::make_unique<mbedtls_aes_context>());
+    mbedtls_aes_setkey_dec(keys.back().get(), partition.title_key.data(), 128);
+  }
+
+  File::IOFile outfile(outfile_path, "wb");
+  if (!outfile)
+  {
+    PanicAlertT("Failed to open the output file \"%s\".\n"
+                "Check that you have permissions to write the target folder and that the media can "
+                "be written.",
+                outfile_path.c_str());
+    return false;
+  }
+
+  if (callback)
+    callback(GetStringT("Files opened, ready to compress."), 0, arg);
+
+  DCZHeader header;
+  header.magic = DCZ_MAGIC;
+  header.version = DCZ_VERSION;
+  header.codec = DCZCodec::Deflate;
+  header.chunk_size = DCZ_CHUNK_SIZE;
+  header.data_size = reader->GetDataSize();
+  header.num_chunks = static_cast<u32>((header.data_size + DCZ_CHUNK_SIZE - 1) / DCZ_CHUNK_SIZE);
+  header.num_partitions = static_cast<u32>(partitions.size());
+
+  std::vector<DCZChunkEntry> chunks(header.num_chunks);
+
+  // The header and the tables are written at the end.
+  u64 position = sizeof(DCZHeader) + sizeof(DCZPartitionEntry) * partitions.size() +
+                 sizeof(DCZChunkEntry) * chunks.size();
+  outfile.Seek(position, SEEK_SET);
+
+  int progress_monitor = std::max<int>(1, header.num_chunks / 1000);
+  bool success = true;
+
+  BlockCompressor compressor(DCZ_CHUNK_SIZE, std::max(std::thread::hardware_concurrency(), 1u));
+
+  // Writes the oldest chunk which is still in flight.
+  u32 num_written = 0;
+  auto write_next_chunk = [&] {
+    CompressionSlot& slot = compressor.GetSlot(num_written);
+    compressor.WaitFor(slot);
+    if (slot.failed)
+      return false;
+
+    DCZChunkEntry& chunk = chunks[num_written++];
+    if (std::all_of(slot.in_buf.begin(), slot.in_buf.end(), [](u8 b) { return b == 0; }))
+    {
+      chunk = DCZChunkEntry{};
+      return true;
+    }
+
+    if (!outfile.WriteBytes(slot.result, slot.result_size))
+    {
+      PanicAlertT("Failed to write the output file \"%s\".\n"
+                  "Check that you have enough space available on the target drive.",
+                  outfile_path.c_str());
+      return false;
+    }
+
+    chunk.offset = position;
+    chunk.size = slot.result_size;
+    chunk.hash = slot.hash;
+    position += slot.result_size;
+    return true;
+  };
+
+  for (u32 i = 0; i < header.num_chunks && success; i++)
+  {
+    if (callback && i % progress_monitor == 0)
+    {
+      const u64 inpos = static_cast<u64>(num_written) * DCZ_CHUNK_SIZE;
+      int ratio = 0;
+      if (inpos != 0)
+        ratio = (int)(100 * position / inpos);
+
+      std::string temp =
+          StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
+                           header.num_chunks, ratio);
+      bool was_cancelled = !callback(temp, (float)i / (float)header.num_chunks, arg);
+      if (was_cancelled)
+      {
+        success = false;
+        break;
+      }
+    }
+
+    if (i >= compressor.GetNumSlots() && !write_next_chunk())
+    {
+      success = false;
+      break;
+    }
+
+    CompressionSlot& slot = compressor.GetSlot(i);
+    const u64 chunk_offset = static_cast<u64>(i) * DCZ_CHUNK_SIZE;
+    const u32 read_size =
+        static_cast<u32>(std::min<u64>(DCZ_CHUNK_SIZE, header.data_size - chunk_offset));
+    if (!reader->Read(chunk_offset, read_size, slot.in_buf.data()))
+    {
+      PanicAlertT("Failed to read from the input file \"%s\".", infile_path.c_str());
+      success = false;
+      break;
+    }
+    std::fill(slot.in_buf.begin() + read_size, slot.in_buf.end(), 0);
+
+    for (u32 j = 0; j < DCZ_CHUNK_SIZE; j += BLOCK_TOTAL_SIZE)
+    {
+      for (size_t k = 0; k < partitions.size(); k++)
+      {
+        if (IsStoredDecrypted(partitions[k], chunk_offset + j))
+        {
+          DecryptBlock(keys[k].get(), &slot.in_buf[j]);
+          break;
+        }
+      }
+    }
+
+    compressor.Submit(&slot);
+  }
+
+  while (success && num_written < header.num_chunks)
+    success = write_next_chunk();
+
+  if (success)
+  {
+    outfile.Seek(0, SEEK_SET);
+    success = outfile.WriteArray(&header, 1) &&
+              outfile.WriteArray(partitions.data(), partitions.size()) &&
+              outfile.WriteArray(chunks.data(), chunks.size());
+  }
+
+  if (!success)
+  {
+    // Remove the incomplete output file.
+    outfile.Close();
+    File::Delete(outfile_path);
+    return false;
+  }
+
+  if (callback)
+    callback(GetStringT("Done compressing disc image."), 1.0f, arg);
+  return true;
+}
+
+}  // namespace
@@ -0,0 +1,129 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// WARNING Code not big-endian safe.
+
+// To create new DCZ files, use ConvertToDCZ.
+
+// Like GCZ, DCZ splits the disc into compressed chunks which can be read independently.
+// The data of Wii partitions is stored decrypted, which makes it compressible, and is
+// encrypted again when it is read. The hash blocks are stored too, so the disc can be
+// restored exactly.
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <mbedtls/aes.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "DiscIO/Blob.h"
+
+namespace DiscIO
+{
+static constexpr u32 DCZ_MAGIC = 0x015A4344;  // "DCZ\x01" (byteswapped to little endian)
+static constexpr u32 DCZ_VERSION = 1;
+
+enum class DCZCodec : u32
+{
+  Deflate = 0,
+};
+
+// DCZ file structure:
+// DCZHeader
+// DCZPartitionEntry partitions[num_partitions]
+// DCZChunkEntry chunks[num_chunks]
+// chunk data
+struct DCZHeader  // 32 bytes
+{
+  u32 magic;
+  u32 version;
+  DCZCodec codec;
+  u32 chunk_size;  // A multiple of the Wii block size
+  u64 data_size;
+  u32 num_chunks;
+  u32 num_partitions;
+};
+
+// Every Wii block from data_offset to data_offset + data_size is stored decrypted.
+struct DCZPartitionEntry  // 40 bytes
+{
+  u64 partition_offset;
+  u64 data_offset;
+  u64 data_size;
+  std::array<u8, 16> title_key;
+};
+
+// A chunk with a size of zero only contains zeroes and isn't stored in the file.
+// A chunk which didn't get smaller is stored as is, which is told apart by its size.
+struct DCZChunkEntry  // 16 bytes
+{
+  u64 offset;
+  u32 size;
+  u32 hash;  // Adler-32 of the stored bytes
+};
+
+class DCZFileReader : public BlobReader
+{
+public:
+  static std::unique_ptr<DCZFileReader> Create(File::IOFile file, const std::string& path);
+  ~DCZFileReader();
+
+  BlobType GetBlobType() const override { return BlobType::DCZ; }
+  u64 GetRawSize() const override { return m_file_size; }
+  u64 GetDataSize() const override { return m_header.data_size; }
+  bool Read(u64 offset, u64 size, u8* out_ptr) override;
+
+  bool SupportsReadWiiDecrypted() const override { return !m_partitions.empty(); }
+  bool ReadWiiDecrypted(u64 offset, u64 size, u8* out_ptr, u64 partition_offset) override;
+
+private:
+  struct Partition
+  {
+    DCZPartitionEntry entry;
+    std::unique_ptr<mbedtls_aes_context> key;
+  };
+
+  // Blocks of a partition which aren't stored decrypted are read like from a plain image
+  // and then decrypted.
+  struct RawPartition
+  {
+    u64 data_offset;
+    std::unique_ptr<mbedtls_aes_context> key;  // nullptr if the ticket is invalid
+  };
+
+  DCZFileReader(File::IOFile file, const std::string& path);
+  bool ReadHeader();
+
+  // Reads the data as it is stored, that is, with the Wii partitions decrypted.
+  bool ReadStored(u64 offset, u64 size, u8* out_ptr);
+  const u8* GetChunk(u64 chunk_index);
+  const Partition* FindPartition(u64 block_offset) const;
+  const RawPartition& GetRawPartition(u64 partition_offset, const Partition* partition);
+  bool ReadRawDecrypted(u64 offset, u64 size, u8* out_ptr, const RawPartition& partition);
+
+  File::IOFile m_file;
+  std::string m_path;
+  u64 m_file_size;
+  DCZHeader m_header;
+  std::vector<Partition> m_partitions;
+  std::vector<DCZChunkEntry> m_chunks;
+
+  std::vector<u8> m_compressed_buffer;
+  std::vector<u8> m_chunk_buffer;
+  u64 m_cached_chunk = UINT64_MAX;
+
+  std::vector<u8> m_encrypted_block;
+  u64 m_encrypted_block_offset = UINT64_MAX;
+
+  std::map<u64, RawPartition> m_raw_partitions;
+  std::vector<u8> m_decrypted_block;
+  u64 m_decrypted_block_offset = UINT64_MAX;
+};
+
+}  // namespace
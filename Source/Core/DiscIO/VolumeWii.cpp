@@ -9,7 +9,6 @@
 #include <cstddef>
 #include <cstring>
 #include <map>
-#include <mbedtls/aes.h>
 #include <mbedtls/sha1.h>
 #include <memory>
 #include <optional>
@@ -19,11 +18,13 @@
 
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
 
 #include "DiscIO/Blob.h"
+#include "DiscIO/BlockCache.h"
 #include "DiscIO/DiscExtractor.h"
 #include "DiscIO/Enums.h"
 #include "DiscIO/Filesystem.h"
@@ -33,9 +34,11 @@ namespace DiscIO
 {
 constexpr u64 PARTITION_DATA_OFFSET = 0x20000;
 
+constexpr size_t MAX_BATCH_BLOCKS = 16;
+
 VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
     : m_pReader(std::move(reader)), m_game_partition(PARTITION_NONE),
-      m_last_decrypted_block(UINT64_MAX)
+      m_cache(BlockCache::GetShared()), m_cache_owner(BlockCache::NewOwnerID())
 {
   _assert_(m_pReader);
 
@@ -101,26 +104,26 @@ VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
         return IOS::ES::TMDReader{std::move(tmd_buffer)};
       };
 
-      auto get_key = [this, partition]() -> std::unique_ptr<mbedtls_aes_context> {
+      auto get_key = [this, partition]() -> std::unique_ptr<Common::AES::CBCDecryptor> {
         const IOS::ES::TicketReader& ticket = *m_partitions[partition].ticket;
         if (!ticket.IsValid())
           return nullptr;
         const std::array<u8, 16> key = ticket.GetTitleKey();
-        std::unique_ptr<mbedtls_aes_context> aes_context = std::make_unique<mbedtls_aes_context>();
-        mbedtls_aes_setkey_dec(aes_context.get(), key.data(), 128);
-        return aes_context;
+        return std::make_unique<Common::AES::CBCDecryptor>(key.data());
       };
 
       m_partitions.emplace(
-          partition, PartitionDetails{Common::Lazy<std::unique_ptr<mbedtls_aes_context>>(get_key),
-                                      Common::Lazy<IOS::ES::TicketReader>(get_ticket),
-                                      Common::Lazy<IOS::ES::TMDReader>(get_tmd), *partition_type});
+          partition,
+          PartitionDetails{Common::Lazy<std::unique_ptr<Common::AES::CBCDecryptor>>(get_key),
+                           Common::Lazy<IOS::ES::TicketReader>(get_ticket),
+                           Common::Lazy<IOS::ES::TMDReader>(get_tmd), *partition_type});
     }
   }
 }
 
 VolumeWii::~VolumeWii()
 {
+  m_cache.Erase(m_cache_owner);
 }
 
 bool VolumeWii::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer, const Partition& partition) const
@@ -135,41 +138,43 @@ bool VolumeWii::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer, const Partition
   auto it = m_partitions.find(partition);
   if (it == m_partitions.end())
     return false;
-  mbedtls_aes_context* aes_context = it->second.key->get();
-  if (!aes_context)
+  const Common::AES::CBCDecryptor* decryptor = it->second.key->get();
+  if (!decryptor)
     return false;
 
-  std::vector<u8> read_buffer(BLOCK_TOTAL_SIZE);
+  const u64 data_offset_on_disc = partition.offset + PARTITION_DATA_OFFSET;
+  const u64 last_block = _Length > 0 ? (_ReadOffset + _Length - 1) / BLOCK_DATA_SIZE : 0;
+
+  // Blocks which were decrypted together and haven't been copied out yet. They're kept here
+  // rather than looked up again, since a large read may push them out of the cache.
+  std::vector<BlockCache::Chunk> batch;
+  size_t batch_pos = 0;
+
   while (_Length > 0)
   {
     // Calculate offsets
-    u64 block_offset_on_disc =
-        partition.offset + PARTITION_DATA_OFFSET + _ReadOffset / BLOCK_DATA_SIZE * BLOCK_TOTAL_SIZE;
+    u64 block = _ReadOffset / BLOCK_DATA_SIZE;
+    u64 block_offset_on_disc = data_offset_on_disc + block * BLOCK_TOTAL_SIZE;
     u64 data_offset_in_block = _ReadOffset % BLOCK_DATA_SIZE;
 
-    if (m_last_decrypted_block != block_offset_on_disc)
+    BlockCache::Chunk decrypted_block;
+    if (batch_pos < batch.size())
+      decrypted_block = std::move(batch[batch_pos++]);
+    else
+      decrypted_block = m_cache.Find(m_cache_owner, block_offset_on_disc);
+
+    if (!decrypted_block)
     {
-      // Read the current block
-      if (!m_pReader->Read(block_offset_on_disc, BLOCK_TOTAL_SIZE, read_buffer.data()))
+      batch = DecryptBlocks(data_offset_on_disc, block, last_block, *decryptor);
+      if (batch.empty())
         return false;
-
-      // Decrypt the block's data.
-      // 0x3D0 - 0x3DF in read_buffer will be overwritten,
-      // but that won't affect anything, because we won't
-      // use the content of read_buffer anymore after this
-      mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, BLOCK_DATA_SIZE, &read_buffer[0x3D0],
-                            &read_buffer[BLOCK_HEADER_SIZE], m_last_decrypted_block_data);
-      m_last_decrypted_block = block_offset_on_disc;
-
-      // The only thing we currently use from the 0x000 - 0x3FF part
-      // of the block is the IV (at 0x3D0), but it also contains SHA-1
-      // hashes that IOS uses to check that discs aren't tampered with.
-      // http://wiibrew.org/wiki/Wii_Disc#Encrypted
+      decrypted_block = std::move(batch[0]);
+      batch_pos = 1;
     }
 
     // Copy the decrypted data
     u64 copy_size = std::min(_Length, BLOCK_DATA_SIZE - data_offset_in_block);
-    memcpy(_pBuffer, &m_last_decrypted_block_data[data_offset_in_block],
+    memcpy(_pBuffer, decrypted_block->data() + data_offset_in_block,
            static_cast<size_t>(copy_size));
 
     // Update offsets
@@ -181,6 +186,49 @@ bool VolumeWii::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer, const Partition
   return true;
 }
 
+std::vector<BlockCache::Chunk>
+VolumeWii::DecryptBlocks(u64 data_offset_on_disc, u64 first_block, u64 last_block,
+                         const Common::AES::CBCDecryptor& decryptor) const
+{
+  u64 num_blocks = 1;
+  while (num_blocks < MAX_BATCH_BLOCKS && first_block + num_blocks <= last_block &&
+         !m_cache.Contains(m_cache_owner,
+                           data_offset_on_disc + (first_block + num_blocks) * BLOCK_TOTAL_SIZE))
+  {
+    num_blocks++;
+  }
+
+  // Read the blocks
+  const u64 first_block_offset_on_disc = data_offset_on_disc + first_block * BLOCK_TOTAL_SIZE;
+  m_read_buffer.resize(num_blocks * BLOCK_TOTAL_SIZE);
+  if (!m_pReader->Read(first_block_offset_on_disc, m_read_buffer.size(), m_read_buffer.data()))
+    return {};
+
+  std::vector<BlockCache::Chunk> blocks;
+  for (u64 i = 0; i < num_blocks; i++)
+  {
+    // Decrypt the block's data.
+    // 0x3D0 - 0x3DF in m_read_buffer will be overwritten,
+    // but that won't affect anything, because we won't
+    // use the content of m_read_buffer anymore after this
+    u8* encrypted_block = &m_read_buffer[i * BLOCK_TOTAL_SIZE];
+    std::vector<u8> decrypted_block(BLOCK_DATA_SIZE);
+    decryptor.Decrypt(&encrypted_block[0x3D0], &encrypted_block[BLOCK_HEADER_SIZE],
+                      decrypted_block.data(), BLOCK_DATA_SIZE);
+
+    // The only thing we currently use from the 0x000 - 0x3FF part
+    // of the block is the IV (at 0x3D0), but it also contains SHA-1
+    // hashes that IOS uses to check that discs aren't tampered with.
+    // http://wiibrew.org/wiki/Wii_Disc#Encrypted
+
+    blocks.push_back(std::make_shared<const std::vector<u8>>(std::move(decrypted_block)));
+    m_cache.Insert(m_cache_owner, first_block_offset_on_disc + i * BLOCK_TOTAL_SIZE,
+                   blocks.back());
+  }
+
+  return blocks;
+}
+
 std::vector<Partition> VolumeWii::GetPartitions() const
 {
   std::vector<Partition> partitions;
@@ -351,8 +399,8 @@ bool VolumeWii::CheckIntegrity(const Partition& partition) const
   auto it = m_partitions.find(partition);
   if (it == m_partitions.end())
     return false;
-  mbedtls_aes_context* aes_context = it->second.key->get();
-  if (!aes_context)
+  const Common::AES::CBCDecryptor* decryptor = it->second.key->get();
+  if (!decryptor)
     return false;
 
   // Get partition data size
@@ -374,7 +422,7 @@ bool VolumeWii::CheckIntegrity(const Partition& partition) const
       WARN_LOG(DISCIO, "Integrity Check: fail at cluster %d: could not read metadata", clusterID);
       return false;
     }
-    mbedtls_aes_crypt_cbc(aes_context, MBEDTLS_AES_DECRYPT, 0x400, IV, clusterMDCrypted, clusterMD);
+    decryptor->Decrypt(IV, clusterMDCrypted, clusterMD, 0x400);
 
     // Some clusters have invalid data and metadata because they aren't
     // meant to be read by the game (for example, holes between files). To
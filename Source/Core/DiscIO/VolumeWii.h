@@ -5,15 +5,16 @@
 #pragma once
 
 #include <map>
-#include <mbedtls/aes.h>
 #include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
 #include "Common/Lazy.h"
 #include "Core/IOS/ES/Formats.h"
+#include "DiscIO/BlockCache.h"
 #include "DiscIO/Volume.h"
 
 // --- this volume type is used for encrypted Wii images ---
@@ -67,18 +68,28 @@ public:
 private:
   struct PartitionDetails
   {
-    Common::Lazy<std::unique_ptr<mbedtls_aes_context>> key;
+    Common::Lazy<std::unique_ptr<Common::AES::CBCDecryptor>> key;
     Common::Lazy<IOS::ES::TicketReader> ticket;
     Common::Lazy<IOS::ES::TMDReader> tmd;
     u32 type;
   };
 
+  // Reads the uncached blocks from first_block up to last_block with one read, decrypts them and
+  // adds them to the cache. Returns the decrypted blocks, or nothing if the read fails.
+  std::vector<BlockCache::Chunk> DecryptBlocks(u64 data_offset_on_disc, u64 first_block,
+                                               u64 last_block,
+                                               const Common::AES::CBCDecryptor& decryptor) const;
+
   std::unique_ptr<BlobReader> m_pReader;
   std::map<Partition, PartitionDetails> m_partitions;
   Partition m_game_partition;
 
-  mutable u64 m_last_decrypted_block;
-  mutable u8 m_last_decrypted_block_data[BLOCK_DATA_SIZE];
+  // Decrypted blocks are kept in the shared BlockCache, keyed by their offset on the disc.
+  // Interleaved reads from different parts of a partition (for example streamed audio or video
+  // while a level loads) would otherwise decrypt the same blocks over and over again.
+  BlockCache& m_cache;
+  const u64 m_cache_owner;
+  mutable std::vector<u8> m_read_buffer;
 };
 
 }  // namespace
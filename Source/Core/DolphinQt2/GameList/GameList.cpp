@@ -246,6 +246,8 @@ void GameList::CompressISO()
       return;
   }
 
+  const QString dcz_filter = tr("Compressed GC/Wii images with decrypted partitions (*.dcz)");
+  QString selected_filter;
   QString dst_path = QFileDialog::getSaveFileName(
       this, compressed ? tr("Select where you want to save the decompressed image") :
                          tr("Select where you want to save the compressed image"),
@@ -254,11 +256,19 @@ void GameList::CompressISO()
           .absoluteFilePath(file.GetGameID())
           .append(compressed ? QStringLiteral(".gcm") : QStringLiteral(".gcz")),
       compressed ? tr("Uncompressed GC/Wii images (*.iso *.gcm)") :
-                   tr("Compressed GC/Wii images (*.gcz)"));
+                   tr("Compressed GC/Wii images (*.gcz)") + QStringLiteral(";;") + dcz_filter,
+      &selected_filter);
 
   if (dst_path.isEmpty())
     return;
 
+  // DCZ is picked either through the filter or by typing the extension.
+  const bool to_dcz =
+      !compressed && (selected_filter == dcz_filter ||
+                      dst_path.endsWith(QStringLiteral(".dcz"), Qt::CaseInsensitive));
+  if (to_dcz && dst_path.endsWith(QStringLiteral(".gcz"), Qt::CaseInsensitive))
+    dst_path.replace(dst_path.size() - 4, 4, QStringLiteral(".dcz"));
+
   QProgressDialog progress_dialog(compressed ? tr("Decompressing...") : tr("Compressing..."),
                                   tr("Abort"), 0, 100, this);
   progress_dialog.setWindowModality(Qt::WindowModal);
@@ -270,6 +280,11 @@ void GameList::CompressISO()
     good = DiscIO::DecompressBlobToFile(original_path.toStdString(), dst_path.toStdString(),
                                         &CompressCB, &progress_dialog);
   }
+  else if (to_dcz)
+  {
+    good = DiscIO::ConvertToDCZ(original_path.toStdString(), dst_path.toStdString(), &CompressCB,
+                                &progress_dialog);
+  }
   else
   {
     good = DiscIO::CompressFileToBlob(original_path.toStdString(), dst_path.toStdString(),
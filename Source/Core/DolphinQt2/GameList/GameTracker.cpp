@@ -11,9 +11,10 @@
 #include "DolphinQt2/Settings.h"
 
 static const QStringList game_filters{
-    QStringLiteral("*.gcm"),  QStringLiteral("*.iso"), QStringLiteral("*.tgc"),
-    QStringLiteral("*.ciso"), QStringLiteral("*.gcz"), QStringLiteral("*.wbfs"),
-    QStringLiteral("*.wad"),  QStringLiteral("*.elf"), QStringLiteral("*.dol")};
+    QStringLiteral("*.gcm"),  QStringLiteral("*.iso"),  QStringLiteral("*.tgc"),
+    QStringLiteral("*.ciso"), QStringLiteral("*.gcz"),  QStringLiteral("*.dcz"),
+    QStringLiteral("*.wbfs"), QStringLiteral("*.wad"),  QStringLiteral("*.elf"),
+    QStringLiteral("*.dol")};
 
 GameTracker::GameTracker(QObject* parent) : QFileSystemWatcher(parent)
 {
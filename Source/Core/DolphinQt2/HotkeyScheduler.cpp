@@ -360,5 +360,8 @@ void HotkeyScheduler::Run()
 
     if (IsHotkey(HK_UNDO_SAVE_STATE))
       State::UndoSaveState();
+
+    if (IsHotkey(HK_REWIND))
+      State::Rewind();
   }
 }
@@ -82,7 +82,7 @@ public:
   wxProgressDialog* dialog;
 };
 
-static constexpr u32 CACHE_REVISION = 3;  // Last changed in PR 5573
+static constexpr u32 CACHE_REVISION = 4;  // Last changed when BlobType::DCZ was added
 
 static bool sorted = false;
 
@@ -757,8 +757,8 @@ void GameListCtrl::RescanList()
 
   post_status(_("Scanning..."));
 
-  const std::vector<std::string> search_extensions = {".gcm",  ".tgc", ".iso", ".ciso", ".gcz",
-                                                      ".wbfs", ".wad", ".dol", ".elf"};
+  const std::vector<std::string> search_extensions = {".gcm", ".tgc", ".iso", ".ciso", ".gcz",
+                                                      ".dcz", ".wbfs", ".wad", ".dol", ".elf"};
   // TODO This could process paths iteratively as they are found
   auto search_results = Common::DoFileSearch(SConfig::GetInstance().m_ISOFolder, search_extensions,
                                              SConfig::GetInstance().m_RecursiveISOFolder);
@@ -1508,11 +1508,13 @@ void GameListCtrl::OnCompressISO(wxCommandEvent& WXUNUSED(event))
       if (iso->GetPlatform() == DiscIO::Platform::WII_DISC && !WiiCompressWarning())
         return;
 
-      path = wxFileSelector(_("Save compressed GCM/ISO"), StrToWxStr(FilePath),
-                            StrToWxStr(FileName) + ".gcz", wxEmptyString,
-                            _("All compressed GC/Wii ISO files (gcz)") +
-                                wxString::Format("|*.gcz|%s", wxGetTranslation(wxALL_FILES)),
-                            wxFD_SAVE, this);
+      path = wxFileSelector(
+          _("Save compressed GCM/ISO"), StrToWxStr(FilePath), StrToWxStr(FileName) + ".gcz",
+          wxEmptyString,
+          _("All compressed GC/Wii ISO files (gcz)") + "|*.gcz|" +
+              _("Compressed GC/Wii ISO files with decrypted partitions (dcz)") +
+              wxString::Format("|*.dcz|%s", wxGetTranslation(wxALL_FILES)),
+          wxFD_SAVE, this);
     }
     if (!path)
       return;
@@ -1533,6 +1535,8 @@ void GameListCtrl::OnCompressISO(wxCommandEvent& WXUNUSED(event))
     if (is_compressed)
       all_good =
           DiscIO::DecompressBlobToFile(iso->GetFileName(), WxStrToStr(path), &CompressCB, &dialog);
+    else if (path.Lower().EndsWith(".dcz"))
+      all_good = DiscIO::ConvertToDCZ(iso->GetFileName(), WxStrToStr(path), &CompressCB, &dialog);
     else
       all_good = DiscIO::CompressFileToBlob(
           iso->GetFileName(), WxStrToStr(path),
@@ -16,12 +16,12 @@ AsyncRequests::AsyncRequests() : m_enable(false), m_passthrough(true)
 {
 }
 
-void AsyncRequests::PullEventsInternal()
+void AsyncRequests::PullEventsInternal(u64 fifo_position)
 {
   std::unique_lock<std::mutex> lock(m_mutex);
   m_empty.Set();
 
-  while (!m_queue.empty())
+  while (!m_queue.empty() && m_queue.front().fifo_position <= fifo_position)
   {
     Event e = m_queue.front();
 
@@ -45,7 +45,8 @@ void AsyncRequests::PullEventsInternal()
         m_merged_efb_pokes.push_back(d);
 
         m_queue.pop();
-      } while (!m_queue.empty() && m_queue.front().type == first_event.type);
+      } while (!m_queue.empty() && m_queue.front().type == first_event.type &&
+               m_queue.front().fifo_position <= fifo_position);
 
       lock.unlock();
       g_renderer->PokeEFB(t, m_merged_efb_pokes.data(), m_merged_efb_pokes.size());
@@ -60,7 +61,11 @@ void AsyncRequests::PullEventsInternal()
     m_queue.pop();
   }
 
-  if (m_wake_me_up_again)
+  // Events which have to wait for more FIFO data are picked up by a later call.
+  if (!m_queue.empty())
+    m_empty.Clear();
+
+  if (m_wake_me_up_again && m_queue.empty())
   {
     m_wake_me_up_again = false;
     m_cond.notify_all();
@@ -84,6 +89,7 @@ void AsyncRequests::PushEvent(const AsyncRequests::Event& event, bool blocking)
     return;
 
   m_queue.push(event);
+  m_queue.back().fifo_position = Fifo::GetSubmittedFifoPosition();
 
   Fifo::RunGpu();
   if (blocking)
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <condition_variable>
+#include <limits>
 #include <mutex>
 #include <queue>
 #include <vector>
@@ -30,6 +31,8 @@ public:
       PERF_QUERY,
     } type;
     u64 time;
+    // Set by PushEvent. The event is only handled once the GPU has seen the FIFO data up to here.
+    u64 fifo_position;
 
     union
     {
@@ -69,10 +72,12 @@ public:
 
   AsyncRequests();
 
-  void PullEvents()
+  // Only handles the events which were pushed before the CPU submitted FIFO data beyond
+  // fifo_position. This orders them with the FIFO in deterministic GPU thread mode.
+  void PullEvents(u64 fifo_position = std::numeric_limits<u64>::max())
   {
     if (!m_empty.IsSet())
-      PullEventsInternal();
+      PullEventsInternal(fifo_position);
   }
   void PushEvent(const Event& event, bool blocking = false);
   void SetEnable(bool enable);
@@ -80,7 +85,7 @@ public:
 
   static AsyncRequests* GetInstance() { return &s_singleton; }
 private:
-  void PullEventsInternal();
+  void PullEventsInternal(u64 fifo_position);
   void HandleEvent(const Event& e);
 
   static AsyncRequests s_singleton;
@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
 
@@ -32,6 +33,9 @@
 namespace Fifo
 {
 static constexpr u32 FIFO_SIZE = 2 * 1024 * 1024;
+// Keeps a single read well below the size of the buffer, so it never has to wait for the GPU
+// thread to drain the buffer more than once.
+static constexpr u32 MAX_DETERMINISTIC_READ_SIZE = 64 * 1024;
 static constexpr int GPU_TIME_SLOT_SIZE = 1000;
 
 static Common::BlockingLoop s_gpu_mainloop;
@@ -66,6 +70,10 @@ static u8* s_video_buffer_pp_read_ptr;
 // FIFO.  Maybe someday it will be under the lock.  For now, because RunGpuLoop
 // polls, it's just atomic.
 // - The pp_read_ptr is the CPU preprocessing version of the read_ptr.
+// - The submitted position counts the bytes the CPU has handed to the GPU. Unlike the pointers,
+// it never moves backwards, so AsyncRequests uses it to order events after the FIFO data which
+// was submitted before them. It's updated after the write_ptr.
+static std::atomic<u64> s_video_buffer_submitted;
 
 static std::atomic<int> s_sync_ticks;
 static bool s_syncing_suspended;
@@ -160,6 +168,8 @@ void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
 {
   if (s_use_deterministic_gpu_thread)
   {
+    // RunGpuOnCpu only wakes the GPU thread once it's done submitting data.
+    s_gpu_mainloop.Wakeup();
     s_gpu_mainloop.Wait();
     if (!s_gpu_mainloop.IsRunning())
       return;
@@ -191,6 +201,11 @@ void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
   }
 }
 
+u64 GetSubmittedFifoPosition()
+{
+  return s_video_buffer_submitted.load();
+}
+
 void PushFifoAuxBuffer(const void* ptr, size_t size)
 {
   if (size > (size_t)(s_fifo_aux_data + FIFO_SIZE - s_fifo_aux_write_ptr))
@@ -241,10 +256,10 @@ static void ReadDataFromFifo(u32 readPtr)
   s_video_buffer_write_ptr += len;
 }
 
-// The deterministic_gpu_thread version.
-static void ReadDataFromFifoOnCPU(u32 readPtr)
+// The deterministic_gpu_thread version. This takes a whole contiguous range of the FIFO at a time,
+// so that it's preprocessed and handed to the GPU thread in one go.
+static void ReadDataFromFifoOnCPU(u32 readPtr, u32 len)
 {
-  size_t len = 32;
   u8* write_ptr = s_video_buffer_write_ptr;
   if (len > (size_t)(s_video_buffer + FIFO_SIZE - write_ptr))
   {
@@ -266,7 +281,7 @@ static void ReadDataFromFifoOnCPU(u32 readPtr)
     size_t existing_len = write_ptr - s_video_buffer_pp_read_ptr;
     if (len > (size_t)(FIFO_SIZE - existing_len))
     {
-      PanicAlert("FIFO out of bounds (existing %zu + new %zu > %u)", existing_len, len, FIFO_SIZE);
+      PanicAlert("FIFO out of bounds (existing %zu + new %u > %u)", existing_len, len, FIFO_SIZE);
       return;
     }
   }
@@ -275,6 +290,7 @@ static void ReadDataFromFifoOnCPU(u32 readPtr)
       DataReader(s_video_buffer_pp_read_ptr, write_ptr + len), nullptr, false);
   // This would have to be locked if the GPU thread didn't spin.
   s_video_buffer_write_ptr = write_ptr + len;
+  s_video_buffer_submitted += len;
 }
 
 void ResetVideoBuffer()
@@ -306,9 +322,9 @@ void RunGpuLoop()
 
         if (s_use_deterministic_gpu_thread)
         {
-          AsyncRequests::GetInstance()->PullEvents();
-
           // All the fifo/CP stuff is on the CPU.  We just need to run the opcode decoder.
+          // The position is read before the write_ptr, so all the data it covers gets decoded.
+          const u64 position = s_video_buffer_submitted.load();
           u8* seen_ptr = s_video_buffer_seen_ptr;
           u8* write_ptr = s_video_buffer_write_ptr;
           // See comment in SyncGPU
@@ -318,6 +334,10 @@ void RunGpuLoop()
                 OpcodeDecoder::Run(DataReader(s_video_buffer_read_ptr, write_ptr), nullptr, false);
             s_video_buffer_seen_ptr = write_ptr;
           }
+
+          // Swaps and EFB accesses only see the FIFO data which the CPU submitted before them,
+          // which makes them deterministic without making the CPU wait for the GPU.
+          AsyncRequests::GetInstance()->PullEvents(position);
         }
         else
         {
@@ -442,13 +462,27 @@ static int RunGpuOnCpu(int ticks)
   CommandProcessor::SCPFifoStruct& fifo = CommandProcessor::fifo;
   bool reset_simd_state = false;
   int available_ticks = int(ticks * SConfig::GetInstance().fSyncGpuOverclock) + s_sync_ticks.load();
+  bool submitted_data = false;
   while (fifo.bFF_GPReadEnable && fifo.CPReadWriteDistance && !AtBreakpoint() &&
          available_ticks >= 0)
   {
+    u32 len = 32;
     if (s_use_deterministic_gpu_thread)
     {
-      ReadDataFromFifoOnCPU(fifo.CPReadPointer);
-      s_gpu_mainloop.Wakeup();
+      // Take everything up to the end of the ring buffer or the breakpoint at once.
+      if (fifo.CPReadPointer <= fifo.CPEnd)
+        len = std::min(static_cast<u32>(fifo.CPReadWriteDistance),
+                       fifo.CPEnd + 32 - fifo.CPReadPointer);
+      const u32 breakpoint_distance = fifo.CPBreakpoint - fifo.CPReadPointer;
+      if (fifo.bFF_BPEnable && fifo.CPBreakpoint > fifo.CPReadPointer &&
+          breakpoint_distance < len && breakpoint_distance % 32 == 0)
+      {
+        len = breakpoint_distance;
+      }
+      len = std::min(len, MAX_DETERMINISTIC_READ_SIZE);
+
+      ReadDataFromFifoOnCPU(fifo.CPReadPointer, len);
+      submitted_data = true;
     }
     else
     {
@@ -465,14 +499,18 @@ static int RunGpuOnCpu(int ticks)
       available_ticks -= cycles;
     }
 
-    if (fifo.CPReadPointer == fifo.CPEnd)
+    if (fifo.CPReadPointer + len == fifo.CPEnd + 32)
       fifo.CPReadPointer = fifo.CPBase;
     else
-      fifo.CPReadPointer += 32;
+      fifo.CPReadPointer += len;
 
-    fifo.CPReadWriteDistance -= 32;
+    fifo.CPReadWriteDistance -= len;
   }
 
+  // Wake the GPU thread once per time slot rather than for every block of data.
+  if (submitted_data)
+    s_gpu_mainloop.Wakeup();
+
   CommandProcessor::SetCPStatusFromGPU();
 
   if (reset_simd_state)
@@ -27,11 +27,12 @@ enum class SyncGPUReason
   EFBPoke,
   PerfQuery,
   BBox,
-  Swap,
   AuxSpace,
 };
 // In deterministic GPU thread mode this waits for the GPU to be done with pending work.
 void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr = true);
+// In deterministic GPU thread mode, the total amount of FIFO data the CPU has handed to the GPU.
+u64 GetSubmittedFifoPosition();
 
 void PushFifoAuxBuffer(const void* ptr, size_t size);
 void* PopFifoAuxBuffer(size_t size);
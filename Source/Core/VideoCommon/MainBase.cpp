@@ -51,7 +51,8 @@ void VideoBackendBase::Video_BeginField(u32 xfbAddr, u32 fbWidth, u32 fbStride,
 {
   if (m_initialized && g_ActiveConfig.bUseXFB && g_renderer)
   {
-    Fifo::SyncGPU(Fifo::SyncGPUReason::Swap);
+    // The swap event is ordered after the FIFO data submitted before it, so there's no need to
+    // wait for the GPU to catch up in deterministic GPU thread mode.
 
     AsyncRequests::Event e;
     e.time = ticks;
@@ -0,0 +1,44 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <gtest/gtest.h>
+#include <mbedtls/aes.h>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
+#include "TestUtil.h"
+
+TEST(AES, CBCDecryptorMatchesMbedtls)
+{
+  const std::vector<u8> key = TestUtil::RandomBytes(16, 1);
+  mbedtls_aes_context context;
+  mbedtls_aes_setkey_dec(&context, key.data(), 128);
+  const Common::AES::CBCDecryptor decryptor(key.data());
+
+  // Sizes which do and don't fill the last group of blocks which are decrypted together.
+  for (size_t size : {16, 48, 64, 112, 0x7C00})
+  {
+    const std::vector<u8> encrypted = TestUtil::RandomBytes(size, static_cast<u32>(size));
+    const std::vector<u8> initial_iv = TestUtil::RandomBytes(16, 2);
+
+    std::vector<u8> expected(size);
+    std::vector<u8> expected_iv = initial_iv;
+    mbedtls_aes_crypt_cbc(&context, MBEDTLS_AES_DECRYPT, size, expected_iv.data(),
+                          encrypted.data(), expected.data());
+
+    std::vector<u8> result(size);
+    std::vector<u8> iv = initial_iv;
+    decryptor.Decrypt(iv.data(), encrypted.data(), result.data(), size);
+    EXPECT_EQ(expected, result) << "size " << size;
+    EXPECT_EQ(expected_iv, iv) << "size " << size;
+
+    // In place
+    result = encrypted;
+    iv = initial_iv;
+    decryptor.Decrypt(iv.data(), result.data(), result.data(), size);
+    EXPECT_EQ(expected, result) << "size " << size;
+  }
+}
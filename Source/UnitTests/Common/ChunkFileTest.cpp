@@ -0,0 +1,40 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+
+TEST(PointerWrap, WriteLimit)
+{
+  std::array<u8, 0x20> data;
+  data.fill(0x5A);
+  u32 value = 0x12345678;
+
+  // Everything fits.
+  std::vector<u8> buffer(sizeof(value) + data.size());
+  u8* ptr = buffer.data();
+  PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+  p.SetWriteLimit(buffer.data() + buffer.size());
+  p.Do(value);
+  p.DoArray(data);
+  EXPECT_EQ(PointerWrap::MODE_WRITE, p.GetMode());
+  EXPECT_EQ(buffer.data() + buffer.size(), ptr);
+
+  // The array doesn't fit, so it and everything after it is only measured.
+  std::vector<u8> small(sizeof(value) + 1, 0);
+  ptr = small.data();
+  PointerWrap q(&ptr, PointerWrap::MODE_WRITE);
+  q.SetWriteLimit(small.data() + small.size());
+  q.Do(value);
+  q.DoArray(data);
+  q.Do(value);
+  EXPECT_EQ(PointerWrap::MODE_MEASURE, q.GetMode());
+  EXPECT_EQ(sizeof(value) * 2 + data.size(), static_cast<size_t>(ptr - small.data()));
+  EXPECT_EQ(0, small.back());
+}
@@ -0,0 +1,66 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// The emitter has to be included first, as gtest's TEST macro conflicts with XEmitter::TEST.
+#include "Common/CommonTypes.h"
+#include "Common/x64Emitter.h"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+constexpr size_t SEGMENT_SIZE = 0x10000;
+constexpr size_t NUM_SEGMENTS = 4;
+
+class TestCodeBlock : public Gen::X64CodeBlock
+{
+public:
+  TestCodeBlock()
+  {
+    AllocCodeSpace(SEGMENT_SIZE * NUM_SEGMENTS);
+    SetSegmentCount(NUM_SEGMENTS);
+  }
+  ~TestCodeBlock() { FreeCodeSpace(); }
+};
+}  // Anonymous namespace
+
+TEST(CodeBlock, SegmentsLimitSpace)
+{
+  TestCodeBlock code;
+
+  EXPECT_EQ(SEGMENT_SIZE, code.GetSegmentSize());
+  EXPECT_EQ(0u, code.GetCurrentSegment());
+  EXPECT_EQ(SEGMENT_SIZE, code.GetSpaceLeft());
+
+  code.NOP(0x100);
+  EXPECT_EQ(SEGMENT_SIZE - 0x100, code.GetSpaceLeft());
+}
+
+TEST(CodeBlock, ClearSegmentKeepsOtherSegments)
+{
+  TestCodeBlock code;
+
+  code.ClearSegment(1);
+  u8* first = code.GetWritableCodePtr();
+  EXPECT_EQ(code.GetSegmentStart(1), first);
+  code.RET();
+
+  code.ClearSegment(2);
+  u8* second = code.GetWritableCodePtr();
+  EXPECT_EQ(code.GetSegmentStart(2), second);
+  EXPECT_EQ(SEGMENT_SIZE, code.GetSpaceLeft());
+  code.RET();
+
+  // Reusing a segment only poisons that segment.
+  code.ClearSegment(1);
+  EXPECT_EQ(0xCC, *first);
+  EXPECT_EQ(0xC3, *second);
+  EXPECT_EQ(1u, code.GetCurrentSegment());
+
+  // Clearing everything starts over at the first segment.
+  code.ClearCodeSpace();
+  EXPECT_EQ(0xCC, *second);
+  EXPECT_EQ(0u, code.GetCurrentSegment());
+  EXPECT_EQ(code.GetSegmentStart(0), code.GetWritableCodePtr());
+}
@@ -0,0 +1,112 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "Common/MPSCQueue.h"
+
+TEST(MPSCQueue, Simple)
+{
+  Common::MPSCQueue<u32, 16> q;
+
+  u32 v;
+  EXPECT_FALSE(q.Pop(v));
+
+  // More than fit into the ring, so that some of them spill.
+  for (u32 i = 0; i < 100; ++i)
+    q.Push(i);
+  EXPECT_EQ(84u, q.GetSpilledPushCount());
+
+  for (u32 i = 0; i < 100; ++i)
+  {
+    ASSERT_TRUE(q.Pop(v));
+    EXPECT_EQ(i, v);
+  }
+  EXPECT_FALSE(q.Pop(v));
+
+  // The ring is used again once the spilled values have been read.
+  q.Push(100);
+  EXPECT_EQ(84u, q.GetSpilledPushCount());
+  ASSERT_TRUE(q.Pop(v));
+  EXPECT_EQ(100u, v);
+}
+
+TEST(MPSCQueue, MultiThreaded)
+{
+  constexpr u32 NUM_WRITERS = 4;
+  constexpr u32 NUM_VALUES = 100000;
+  Common::MPSCQueue<u32, 64> q;
+
+  std::vector<std::thread> writers;
+  for (u32 writer = 0; writer < NUM_WRITERS; ++writer)
+  {
+    writers.emplace_back([&q, writer] {
+      for (u32 i = 0; i < NUM_VALUES; ++i)
+        q.Push(writer << 24 | i);
+    });
+  }
+
+  // The values of each writer must arrive complete and in order.
+  std::array<u32, NUM_WRITERS> next{};
+  for (u32 count = 0; count < NUM_WRITERS * NUM_VALUES;)
+  {
+    u32 v;
+    if (!q.Pop(v))
+      continue;
+    const u32 writer = v >> 24;
+    ASSERT_LT(writer, NUM_WRITERS);
+    ASSERT_EQ(next[writer], v & 0xFFFFFF);
+    next[writer]++;
+    count++;
+  }
+
+  for (std::thread& writer : writers)
+    writer.join();
+
+  u32 v;
+  EXPECT_FALSE(q.Pop(v));
+}
+
+// With a tiny ring, writers keep switching between the ring and the spill list.
+TEST(MPSCQueue, MultiThreadedSpilling)
+{
+  constexpr u32 NUM_WRITERS = 8;
+  constexpr u32 NUM_VALUES = 20000;
+  Common::MPSCQueue<u32, 2> q;
+
+  std::vector<std::thread> writers;
+  for (u32 writer = 0; writer < NUM_WRITERS; ++writer)
+  {
+    writers.emplace_back([&q, writer] {
+      for (u32 i = 0; i < NUM_VALUES; ++i)
+      {
+        q.Push(writer << 24 | i);
+        if (i % 64 == 0)
+          std::this_thread::yield();
+      }
+    });
+  }
+
+  std::array<u32, NUM_WRITERS> next{};
+  for (u32 count = 0; count < NUM_WRITERS * NUM_VALUES;)
+  {
+    u32 v;
+    if (!q.Pop(v))
+    {
+      std::this_thread::yield();
+      continue;
+    }
+    const u32 writer = v >> 24;
+    ASSERT_LT(writer, NUM_WRITERS);
+    ASSERT_EQ(next[writer], v & 0xFFFFFF);
+    next[writer]++;
+    count++;
+  }
+
+  for (std::thread& writer : writers)
+    writer.join();
+}
@@ -0,0 +1,45 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/MemArena.h"
+
+namespace
+{
+constexpr size_t SEGMENT_SIZE = 2 * MemArena::HUGE_PAGE_SIZE;
+
+void CheckViewsAlias(bool use_huge_pages)
+{
+  MemArena arena;
+  arena.GrabSHMSegment(SEGMENT_SIZE, use_huge_pages);
+
+  u8* whole = static_cast<u8*>(arena.CreateView(0, SEGMENT_SIZE));
+  ASSERT_NE(nullptr, whole);
+  // A view which isn't aligned to a huge page, like the logical memory views.
+  u8* part = static_cast<u8*>(arena.CreateView(0x20000, 0x20000));
+  ASSERT_NE(nullptr, part);
+
+  whole[0x20010] = 0x12;
+  EXPECT_EQ(0x12, part[0x10]);
+  part[0x1FFFF] = 0x34;
+  EXPECT_EQ(0x34, whole[0x3FFFF]);
+
+  arena.ReleaseView(part, 0x20000);
+  arena.ReleaseView(whole, SEGMENT_SIZE);
+  arena.ReleaseSHMSegment();
+  EXPECT_FALSE(arena.UsesHugePages());
+}
+}  // Anonymous namespace
+
+TEST(MemArena, ViewsAlias)
+{
+  CheckViewsAlias(false);
+}
+
+TEST(MemArena, ViewsAliasWithHugePages)
+{
+  CheckViewsAlias(true);
+}
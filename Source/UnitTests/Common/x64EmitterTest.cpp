@@ -18,6 +18,7 @@
 #undef TEST
 
 #include "Common/CPUDetect.h"
+#include "Common/x64ABI.h"
 #include "Common/x64Emitter.h"
 
 namespace Gen
@@ -1079,4 +1080,61 @@ FMA4_TEST(VFNMSUB, S, false)
 FMA4_TEST(VFMADDSUB, P, true)
 FMA4_TEST(VFMSUBADD, P, true)
 
+// Without FMA (or in deterministic mode), Jit64 either copies c into a scratch register and rounds
+// the fmadds result in place in the destination, or with AVX multiplies straight from c and rounds
+// straight from the scratch register. Both sequences have to give the same result.
+TEST_F(x64EmitterTest, FmaddsSequencesAgree)
+{
+  cpu_info = CPUInfo();
+  if (!cpu_info.bAVX)
+    return;
+
+  // d, a and b; the results are rounded, overflow and underflow single precision.
+  const double inputs[][3] = {
+      {1.1, 3.3, 0.7}, {1e30, 1e10, -1.0}, {1e-30, 1e-20, 0.0}, {-2.5, 0.1, 1e-8}};
+
+  for (const auto& input : inputs)
+  {
+    const double d = input[0], a = input[1], b = input[2];
+    const double product = d * a;
+    const double expected = static_cast<float>(product + b);
+
+    for (bool vex : {false, true})
+    {
+      X64CodeBlock code;
+      code.AllocCodeSpace(4096);
+      const auto run = reinterpret_cast<u64 (*)(const double*)>(code.GetCodePtr());
+
+      // d = XMM5, a = XMM3, b = XMM4, scratch = XMM1.
+      code.MOVSD(XMM5, MatR(ABI_PARAM1));
+      code.MOVSD(XMM3, MDisp(ABI_PARAM1, 8));
+      code.MOVSD(XMM4, MDisp(ABI_PARAM1, 16));
+      if (vex)
+      {
+        code.VMULSD(XMM1, XMM5, R(XMM3));
+        code.ADDSD(XMM1, R(XMM4));
+        code.CVTSD2SS(XMM5, R(XMM1));
+      }
+      else
+      {
+        code.MOVAPD(XMM1, R(XMM5));
+        code.MULSD(XMM1, R(XMM3));
+        code.ADDSD(XMM1, R(XMM4));
+        code.MOVAPD(XMM5, R(XMM1));
+        code.CVTSD2SS(XMM5, R(XMM5));
+      }
+      code.CVTSS2SD(XMM5, R(XMM5));
+      code.MOVQ_xmm(R(ABI_RETURN), XMM5);
+      code.RET();
+
+      const u64 result = run(input);
+      u64 expected_bits;
+      std::memcpy(&expected_bits, &expected, sizeof(expected_bits));
+      EXPECT_EQ(expected_bits, result) << (vex ? "vex" : "sse") << ", d " << d << ", a " << a
+                                       << ", b " << b;
+      code.FreeCodeSpace();
+    }
+  }
+}
+
 }  // namespace Gen
@@ -7,6 +7,7 @@
 #include <array>
 #include <bitset>
 #include <string>
+#include <vector>
 
 #include "Common/Config/Config.h"
 #include "Common/FileUtil.h"
@@ -14,6 +15,7 @@
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "TestUtil.h"
 #include "UICommon/UICommon.h"
 
 // Numbers are chosen randomly to make sure the correct one is given.
@@ -347,3 +349,192 @@ TEST(CoreTiming, Overclocking)
   SConfig::GetInstance().m_OCFactor = 1.0;
   AdvanceAndCheck(4, MAX_SLICE_LENGTH);
 }
+
+TEST(CoreTiming, RemoveByHandle)
+{
+  ScopeInit guard;
+
+  CoreTiming::EventType* cb_a = CoreTiming::RegisterEvent("callbackA", CallbackTemplate<0>);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  const CoreTiming::EventHandle first = CoreTiming::ScheduleEvent(100, cb_a, CB_IDS[0]);
+  CoreTiming::ScheduleEvent(200, cb_a, CB_IDS[0]);
+  CoreTiming::RemoveEvent(first);
+  AdvanceAndCheck(0, MAX_SLICE_LENGTH, 0, -100);
+
+  // The handle is stale now, even though its slot gets reused.
+  const CoreTiming::EventHandle second = CoreTiming::ScheduleEvent(300, cb_a, CB_IDS[0]);
+  CoreTiming::RemoveEvent(first);
+  EXPECT_EQ(300, PowerPC::ppcState.downcount);
+  CoreTiming::RemoveEvent(second);
+  CoreTiming::Advance();
+  EXPECT_EQ(MAX_SLICE_LENGTH, PowerPC::ppcState.downcount);
+}
+
+TEST(CoreTiming, HandlesStayStaleAfterClear)
+{
+  ScopeInit guard;
+
+  CoreTiming::EventType* cb_a = CoreTiming::RegisterEvent("callbackA", CallbackTemplate<0>);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  // The new event reuses the slot of the cleared one, but not its handle.
+  const CoreTiming::EventHandle cleared = CoreTiming::ScheduleEvent(100, cb_a, CB_IDS[0]);
+  CoreTiming::ClearPendingEvents();
+  CoreTiming::ScheduleEvent(200, cb_a, CB_IDS[0]);
+  CoreTiming::RemoveEvent(cleared);
+  AdvanceAndCheck(0, MAX_SLICE_LENGTH, 0, -100);
+}
+
+TEST(CoreTiming, HandlesSurviveClockChange)
+{
+  ScopeInit guard;
+
+  CoreTiming::EventType* cb_a = CoreTiming::RegisterEvent("callbackA", CallbackTemplate<0>);
+  CoreTiming::EventType* cb_b = CoreTiming::RegisterEvent("callbackB", CallbackTemplate<1>);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  const CoreTiming::EventHandle b = CoreTiming::ScheduleEvent(2000, cb_b, CB_IDS[1]);
+  CoreTiming::ScheduleEvent(1000, cb_a, CB_IDS[0]);
+  EXPECT_EQ(1000, PowerPC::ppcState.downcount);
+
+  // Doubling the clock doubles the distance of each event.
+  CoreTiming::AdjustEventQueueTimes(2, 1);
+  CoreTiming::RemoveEvent(b);
+  AdvanceAndCheck(0, MAX_SLICE_LENGTH, 0, -1000);
+}
+
+namespace ManyEventsTest
+{
+static std::vector<s64> s_times;
+static size_t s_ran = 0;
+static s64 s_last_time = 0;
+static u64 s_last_index = 0;
+
+static void OrderCallback(u64 userdata, s64 lateness)
+{
+  const s64 time = static_cast<s64>(CoreTiming::GetTicks()) - lateness;
+  EXPECT_EQ(s_times[userdata], time);
+  EXPECT_TRUE(time > s_last_time || (time == s_last_time && userdata > s_last_index));
+  s_last_time = time;
+  s_last_index = userdata;
+  s_times[userdata] = -1;
+  ++s_ran;
+}
+}
+
+// Spreads events from a few cycles up to far beyond the scheduler's wheel, removes some of
+// them, and checks that the rest run in order.
+TEST(CoreTiming, ManyEvents)
+{
+  using namespace ManyEventsTest;
+
+  ScopeInit guard;
+
+  CoreTiming::EventType* cb = CoreTiming::RegisterEvent("callbackOrder", OrderCallback);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  TestUtil::Random random;
+  std::vector<CoreTiming::EventHandle> handles;
+  s_times.clear();
+  for (u64 i = 0; i < 20000; i++)
+  {
+    const s64 cycles = (random.Next() >> 8) % (i % 3 == 0 ? 100000000 : 100000);
+    s_times.push_back(static_cast<s64>(CoreTiming::GetTicks()) + cycles);
+    handles.push_back(CoreTiming::ScheduleEvent(cycles, cb, i));
+  }
+
+  size_t removed = 0;
+  for (size_t i = 0; i < handles.size(); i += 7)
+  {
+    CoreTiming::RemoveEvent(handles[i]);
+    s_times[i] = -1;
+    removed++;
+  }
+
+  s_ran = 0;
+  s_last_time = 0;
+  s_last_index = 0;
+  while (s_ran + removed < handles.size())
+  {
+    PowerPC::ppcState.downcount = 0;
+    CoreTiming::Advance();
+  }
+  EXPECT_EQ(MAX_SLICE_LENGTH, PowerPC::ppcState.downcount);
+}
+
+namespace RecurringEventsTest
+{
+static CoreTiming::EventType* s_recurring;
+static u64 s_ran = 0;
+static u64 s_far_ran = 0;
+
+// Like the VI, audio and DSP events, which reschedule themselves every few thousand cycles.
+static void RecurringCallback(u64 userdata, s64 lateness)
+{
+  EXPECT_EQ(0, lateness);
+  ++s_ran;
+  CoreTiming::ScheduleEvent(1000 + static_cast<s64>(userdata * 677 % 4000) - lateness, s_recurring,
+                            userdata);
+}
+
+static void FarCallback(u64 userdata, s64 lateness)
+{
+  ++s_far_ran;
+}
+
+static void RemovedCallback(u64 userdata, s64 lateness)
+{
+  ADD_FAILURE() << "Removed event " << userdata << " ran";
+}
+}
+
+// What emulation mostly does: recurring events which reschedule themselves, and short-lived
+// events which are removed by handle before they run, while a backlog of far-away events waits
+// beyond the wheel.
+TEST(CoreTiming, RecurringEvents)
+{
+  using namespace RecurringEventsTest;
+
+  ScopeInit guard;
+
+  s_recurring = CoreTiming::RegisterEvent("callbackRecurring", RecurringCallback);
+  CoreTiming::EventType* cb_far = CoreTiming::RegisterEvent("callbackFar", FarCallback);
+  CoreTiming::EventType* cb_removed = CoreTiming::RegisterEvent("callbackRemoved", RemovedCallback);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  TestUtil::Random random;
+  for (u64 i = 0; i < 2000; i++)
+    CoreTiming::ScheduleEvent(100000000 + (random.Next() >> 8) % 100000000, cb_far, i);
+  for (u64 i = 0; i < 32; i++)
+    CoreTiming::ScheduleEvent(1000 + i * 100, s_recurring, i);
+
+  s_ran = 0;
+  s_far_ran = 0;
+  for (u64 i = 0; s_ran < 10000; i++)
+  {
+    CoreTiming::RemoveEvent(CoreTiming::ScheduleEvent(5000 + i % 3000, cb_removed, i));
+    PowerPC::ppcState.downcount = 0;
+    CoreTiming::Advance();
+  }
+  // The recurring events only get as far as a few million cycles.
+  EXPECT_GT(100000000u, CoreTiming::GetTicks());
+  EXPECT_EQ(0u, s_far_ran);
+
+  while (s_far_ran < 2000)
+  {
+    PowerPC::ppcState.downcount = 0;
+    CoreTiming::Advance();
+  }
+  EXPECT_LE(100000000u, CoreTiming::GetTicks());
+}
@@ -0,0 +1,202 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/DVD/DVDReadAhead.h"
+#include "Core/HW/DVD/DVDThread.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/BlockCache.h"
+#include "DiscIO/Enums.h"
+#include "DiscIO/Volume.h"
+
+namespace
+{
+constexpr u64 DISC_SIZE = 0x400000;
+constexpr u32 REQUEST_SIZE = 0x8000;
+const DiscIO::Partition PARTITION(0x50000);
+
+u8 GetDiscByte(u64 offset, const DiscIO::Partition& partition)
+{
+  return static_cast<u8>(offset / 0x100 + offset + partition.offset / 0x10000);
+}
+
+// Every partition holds DISC_SIZE bytes which depend on their offset. Counts the reads that
+// actually reach the volume.
+class TestVolume final : public DiscIO::Volume
+{
+public:
+  bool Read(u64 offset, u64 length, u8* buffer, const DiscIO::Partition& partition) const override
+  {
+    m_reads++;
+    if (offset + length > DISC_SIZE)
+      return false;
+    for (u64 i = 0; i < length; i++)
+      buffer[i] = GetDiscByte(offset + i, partition);
+    return true;
+  }
+
+  std::string GetGameID(const DiscIO::Partition& partition) const override { return {}; }
+  std::string GetMakerID(const DiscIO::Partition& partition) const override { return {}; }
+  std::optional<u16> GetRevision(const DiscIO::Partition& partition) const override { return {}; }
+  std::string GetInternalName(const DiscIO::Partition& partition) const override { return {}; }
+  std::vector<u32> GetBanner(int* width, int* height) const override { return {}; }
+  std::string GetApploaderDate(const DiscIO::Partition& partition) const override { return {}; }
+  DiscIO::Platform GetVolumeType() const override { return DiscIO::Platform::GAMECUBE_DISC; }
+  DiscIO::Region GetRegion() const override { return DiscIO::Region::UNKNOWN_REGION; }
+  DiscIO::Country GetCountry(const DiscIO::Partition& partition) const override
+  {
+    return DiscIO::Country::COUNTRY_UNKNOWN;
+  }
+  DiscIO::BlobType GetBlobType() const override { return DiscIO::BlobType::PLAIN; }
+  u64 GetSize() const override { return DISC_SIZE; }
+  u64 GetRawSize() const override { return DISC_SIZE; }
+
+  mutable u32 m_reads = 0;
+};
+
+class DVDReadAheadTest : public testing::Test
+{
+protected:
+  DVDReadAheadTest() : m_cache(DiscIO::BlockCache::DEFAULT_CAPACITY), m_read_ahead(m_cache) {}
+  void ExpectRead(u64 offset, const DiscIO::Partition& partition = PARTITION)
+  {
+    std::vector<u8> buffer(REQUEST_SIZE);
+    ASSERT_TRUE(m_read_ahead.Read(m_volume, offset, REQUEST_SIZE, buffer.data(), partition));
+    for (u32 i = 0; i < REQUEST_SIZE; i++)
+      ASSERT_EQ(GetDiscByte(offset + i, partition), buffer[i]) << "at " << offset + i;
+  }
+
+  // Does what the DVD thread does between requests.
+  u32 ReadAheadUntilDone()
+  {
+    u32 calls = 0;
+    while (m_read_ahead.IsPending())
+    {
+      m_read_ahead.ReadNextBlock(m_volume);
+      calls++;
+    }
+    return calls;
+  }
+
+  TestVolume m_volume;
+  DiscIO::BlockCache m_cache;
+  DVDThread::ReadAhead m_read_ahead;
+};
+}  // Anonymous namespace
+
+TEST_F(DVDReadAheadTest, RandomReadsAreNotReadAhead)
+{
+  for (u64 offset : {0x120000, 0x8000, 0x340000, 0x10000, 0x200000})
+  {
+    ExpectRead(offset);
+    EXPECT_FALSE(m_read_ahead.IsPending());
+  }
+
+  const DVDThread::ReadAheadStats stats = m_read_ahead.GetStats();
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(5u, stats.misses);
+  EXPECT_EQ(0u, stats.blocks_read_ahead);
+  EXPECT_EQ(0u, m_cache.GetSize());
+}
+
+TEST_F(DVDReadAheadTest, SequentialReadsAreServedFromTheCache)
+{
+  // The third read in a row makes it a stream.
+  ExpectRead(0x100000);
+  ExpectRead(0x100000 + REQUEST_SIZE);
+  EXPECT_FALSE(m_read_ahead.IsPending());
+  ExpectRead(0x100000 + 2 * REQUEST_SIZE);
+  EXPECT_TRUE(m_read_ahead.IsPending());
+
+  const u32 blocks = ReadAheadUntilDone();
+  EXPECT_EQ(DVDThread::ReadAhead::BLOCKS_AHEAD + 1, blocks);
+  EXPECT_EQ(blocks, m_read_ahead.GetStats().blocks_read_ahead);
+
+  // The rest of the stream is served from the cache without touching the volume.
+  const u32 volume_reads = m_volume.m_reads;
+  for (u64 offset = 0x100000 + 3 * REQUEST_SIZE; offset < 0x180000; offset += REQUEST_SIZE)
+  {
+    ExpectRead(offset);
+    EXPECT_EQ(volume_reads, m_volume.m_reads);
+  }
+
+  const DVDThread::ReadAheadStats stats = m_read_ahead.GetStats();
+  EXPECT_EQ(3u, stats.misses);
+  EXPECT_EQ((0x80000 - 3 * REQUEST_SIZE) / REQUEST_SIZE, stats.hits);
+}
+
+TEST_F(DVDReadAheadTest, UnalignedReadsSpanningBlocks)
+{
+  for (u64 offset = 0x20100; offset < 0x20100 + 3 * REQUEST_SIZE; offset += REQUEST_SIZE)
+    ExpectRead(offset);
+  ReadAheadUntilDone();
+
+  const u64 hits = m_read_ahead.GetStats().hits;
+  for (u64 offset = 0x20100 + 3 * REQUEST_SIZE; offset < 0x60000; offset += REQUEST_SIZE)
+    ExpectRead(offset);
+  EXPECT_LT(hits, m_read_ahead.GetStats().hits);
+}
+
+TEST_F(DVDReadAheadTest, OtherPartitionBreaksTheStream)
+{
+  ExpectRead(0);
+  ExpectRead(REQUEST_SIZE);
+  ExpectRead(2 * REQUEST_SIZE, DiscIO::PARTITION_NONE);
+  EXPECT_FALSE(m_read_ahead.IsPending());
+
+  ExpectRead(3 * REQUEST_SIZE, DiscIO::PARTITION_NONE);
+  ExpectRead(4 * REQUEST_SIZE, DiscIO::PARTITION_NONE);
+  EXPECT_TRUE(m_read_ahead.IsPending());
+  ReadAheadUntilDone();
+
+  // The blocks are kept apart by partition.
+  const u64 hits = m_read_ahead.GetStats().hits;
+  ExpectRead(5 * REQUEST_SIZE, PARTITION);
+  EXPECT_EQ(hits, m_read_ahead.GetStats().hits);
+  ExpectRead(5 * REQUEST_SIZE, DiscIO::PARTITION_NONE);
+  EXPECT_EQ(hits + 1, m_read_ahead.GetStats().hits);
+}
+
+TEST_F(DVDReadAheadTest, StopsAtTheEndOfTheDisc)
+{
+  const u64 start = DISC_SIZE - 4 * REQUEST_SIZE;
+  for (u64 offset = start; offset < start + 3 * REQUEST_SIZE; offset += REQUEST_SIZE)
+    ExpectRead(offset);
+  EXPECT_TRUE(m_read_ahead.IsPending());
+
+  // Only the blocks up to the end of the disc can be read.
+  ReadAheadUntilDone();
+  EXPECT_EQ(1u, m_read_ahead.GetStats().blocks_read_ahead);
+  ExpectRead(start + 3 * REQUEST_SIZE);
+  EXPECT_EQ(1u, m_read_ahead.GetStats().hits);
+}
+
+TEST_F(DVDReadAheadTest, ClearDropsBlocksAndStream)
+{
+  for (u64 offset = 0; offset < 3 * REQUEST_SIZE; offset += REQUEST_SIZE)
+    ExpectRead(offset);
+  ReadAheadUntilDone();
+  EXPECT_NE(0u, m_cache.GetSize());
+
+  m_read_ahead.Clear();
+  EXPECT_EQ(0u, m_cache.GetSize());
+  EXPECT_FALSE(m_read_ahead.IsPending());
+
+  ExpectRead(3 * REQUEST_SIZE);
+  EXPECT_EQ(0u, m_read_ahead.GetStats().hits);
+  EXPECT_FALSE(m_read_ahead.IsPending());
+
+  m_read_ahead.ResetStats();
+  const DVDThread::ReadAheadStats stats = m_read_ahead.GetStats();
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(0u, stats.misses);
+  EXPECT_EQ(0u, stats.blocks_read_ahead);
+}
@@ -0,0 +1,194 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <string>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/Gekko.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+// Runs fmadd and its relatives through Jit64 and checks that NaN results match the interpreter's.
+// Jit64 only orders input NaNs like the PowerPC with accurate NaNs, so these tests enable them.
+
+namespace
+{
+constexpr u32 CODE_ADDRESS = 0x3000;
+constexpr u32 MSR_FP = 1 << (31 - 18);
+
+// The payloads sit at the top of the mantissa so that they survive rounding to single precision.
+constexpr u64 NAN_1 = 0x7FF8100000000000;
+constexpr u64 NAN_2 = 0x7FF8200000000000;
+constexpr u64 NAN_3 = 0x7FF8300000000000;
+constexpr u64 SNAN = 0x7FF4000000000000;
+constexpr u64 ONE = 0x3FF0000000000000;
+constexpr u64 INF = 0x7FF0000000000000;
+constexpr u64 ZERO = 0;
+
+struct Inputs
+{
+  u64 a;
+  u64 b;
+  u64 c;
+};
+
+// All combinations of a NaN in one of a or c with a different NaN or none in b, plus NaNs that
+// are generated from non-NaN inputs.
+constexpr std::array<Inputs, 12> NAN_INPUTS{{
+    {NAN_1, NAN_2, ONE},
+    {ONE, NAN_2, NAN_3},
+    {NAN_1, NAN_2, NAN_3},
+    {NAN_1, ONE, NAN_3},
+    {NAN_1, ONE, ONE},
+    {ONE, ONE, NAN_3},
+    {ONE, NAN_2, ONE},
+    {SNAN, NAN_2, ONE},
+    {ONE, SNAN, NAN_3},
+    {INF, NAN_2, ZERO},
+    {INF, ONE, ZERO},
+    {INF, INF | (1ULL << 63), ONE},
+}};
+
+// fmadd, fmsub, fnmsub and fnmadd in the order of their extended opcodes.
+constexpr std::array<u32, 4> SUBOPS{{29, 28, 30, 31}};
+
+class ScopeInit final
+{
+public:
+  ScopeInit() : m_profile_path(File::CreateTempDir())
+  {
+    Core::DeclareAsCPUThread();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    SConfig::GetInstance().bAccurateNaNs = true;
+    Memory::Init();
+    PowerPC::Init(PowerPC::CORE_JIT64);
+    CoreTiming::Init();
+  }
+  ~ScopeInit()
+  {
+    CoreTiming::Shutdown();
+    PowerPC::Shutdown();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    Core::UndeclareAsCPUThread();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+private:
+  std::string m_profile_path;
+};
+
+// frD = frA * frC +/- frB with D = 4, A = 1, B = 2 and C = 3.
+UGeckoInstruction Encode(u32 opcd, u32 subop5)
+{
+  return (opcd << 26) | (4 << 21) | (1 << 16) | (2 << 11) | (3 << 6) | (subop5 << 1);
+}
+
+void SetInputs(const Inputs& inputs)
+{
+  PowerPC::ppcState.msr = MSR_FP;
+  PowerPC::ppcState.pc = CODE_ADDRESS;
+  PowerPC::ppcState.npc = CODE_ADDRESS;
+  for (int i = 0; i < 2; ++i)
+  {
+    PowerPC::ppcState.ps[1][i] = inputs.a;
+    PowerPC::ppcState.ps[2][i] = inputs.b;
+    PowerPC::ppcState.ps[3][i] = inputs.c;
+    PowerPC::ppcState.ps[4][i] = 0;
+  }
+}
+
+std::array<u64, 2> Result()
+{
+  return {{PowerPC::ppcState.ps[4][0], PowerPC::ppcState.ps[4][1]}};
+}
+
+std::array<u64, 2> RunInterpreter(UGeckoInstruction inst, const Inputs& inputs)
+{
+  SetInputs(inputs);
+  GetInterpreterOp(inst)(inst);
+  return Result();
+}
+
+std::array<u64, 2> RunJit(UGeckoInstruction inst, const Inputs& inputs)
+{
+  // The instruction is followed by a branch to itself, which keeps the JIT busy until the
+  // timeslice is over. The CPU is not running, so it returns to us at that point.
+  JitInterface::ClearCache();
+  Memory::Write_U32(inst.hex, CODE_ADDRESS);
+  Memory::Write_U32(0x48000000, CODE_ADDRESS + 4);
+  SetInputs(inputs);
+  PowerPC::SingleStep();
+  EXPECT_EQ(CODE_ADDRESS + 4, PowerPC::ppcState.pc);
+  return Result();
+}
+
+void CheckAgainstInterpreter(u32 opcd)
+{
+  for (u32 subop5 : SUBOPS)
+  {
+    const UGeckoInstruction inst = Encode(opcd, subop5);
+    for (const Inputs& inputs : NAN_INPUTS)
+    {
+      SCOPED_TRACE(testing::Message() << std::hex << "instruction " << inst.hex << ", a "
+                                      << inputs.a << ", b " << inputs.b << ", c " << inputs.c);
+      const std::array<u64, 2> expected = RunInterpreter(inst, inputs);
+      EXPECT_EQ(expected[0], RunJit(inst, inputs)[0]);
+      if (opcd != 63)
+        EXPECT_EQ(expected[1], Result()[1]);
+    }
+  }
+}
+
+// Runs the test once with FMA, if the host has it, and once without.
+template <typename F>
+void WithAndWithoutFMA(F test)
+{
+  const bool had_fma = cpu_info.bFMA;
+  if (had_fma)
+  {
+    SCOPED_TRACE("FMA");
+    test();
+  }
+  cpu_info.bFMA = false;
+  {
+    SCOPED_TRACE("no FMA");
+    test();
+  }
+  cpu_info.bFMA = had_fma;
+}
+}  // Anonymous namespace
+
+TEST(Jit64Fmadd, DoubleNaNsMatchInterpreter)
+{
+  ScopeInit guard;
+  WithAndWithoutFMA([] { CheckAgainstInterpreter(63); });
+}
+
+TEST(Jit64Fmadd, SingleNaNsMatchInterpreter)
+{
+  ScopeInit guard;
+  WithAndWithoutFMA([] { CheckAgainstInterpreter(59); });
+}
+
+TEST(Jit64Fmadd, PairedNaNsMatchInterpreter)
+{
+  ScopeInit guard;
+  WithAndWithoutFMA([] { CheckAgainstInterpreter(4); });
+}
@@ -0,0 +1,164 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
+
+namespace
+{
+struct Node
+{
+  u32 key;
+  Node* next;
+};
+
+using NodeTable = IntrusiveHashTable<Node, &Node::key, &Node::next>;
+
+size_t CountWithKey(const NodeTable& table, u32 key)
+{
+  size_t count = 0;
+  table.ForEachWithKey(key, [&count](const Node&) { count++; });
+  return count;
+}
+}  // Anonymous namespace
+
+TEST(IntrusiveHashTable, InsertFindErase)
+{
+  std::array<Node, 3> nodes{{{0x80003100, nullptr}, {0x80003100, nullptr}, {0x80004000, nullptr}}};
+  NodeTable table;
+
+  for (Node& node : nodes)
+    table.Insert(&node);
+
+  EXPECT_EQ(2u, CountWithKey(table, 0x80003100));
+  EXPECT_EQ(1u, CountWithKey(table, 0x80004000));
+  EXPECT_EQ(0u, CountWithKey(table, 0x80005000));
+  EXPECT_EQ(&nodes[2], table.Find(0x80004000, [](const Node&) { return true; }));
+  EXPECT_EQ(&nodes[1],
+            table.Find(0x80003100, [&nodes](const Node& node) { return &node == &nodes[1]; }));
+
+  table.Erase(&nodes[0]);
+  EXPECT_EQ(1u, CountWithKey(table, 0x80003100));
+  EXPECT_EQ(nullptr,
+            table.Find(0x80003100, [&nodes](const Node& node) { return &node == &nodes[0]; }));
+}
+
+TEST(IntrusiveHashTable, Rehash)
+{
+  std::vector<Node> nodes(0x10000);
+  NodeTable table;
+
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    nodes[i].key = 0x80000000 + static_cast<u32>(i) * 4;
+    table.Insert(&nodes[i]);
+  }
+
+  size_t visited = 0;
+  table.ForEach([&visited](const Node&) { visited++; });
+  EXPECT_EQ(nodes.size(), visited);
+
+  for (const Node& node : nodes)
+    EXPECT_EQ(&node, table.Find(node.key, [](const Node&) { return true; }));
+}
+
+TEST(BlockRangeMap, EraseKeepsProbeSequences)
+{
+  BlockRangeMap map;
+  std::vector<JitBlock> blocks(0x2000);
+
+  // Enough macro blocks to force the table to grow several times.
+  for (u32 i = 0; i < blocks.size(); i++)
+    map[i * 0x100].push_back(&blocks[i]);
+
+  // Erase every other macro block, which moves entries around within the probe sequences.
+  for (u32 i = 0; i < blocks.size(); i += 2)
+    map.Erase(i * 0x100);
+
+  for (u32 i = 0; i < blocks.size(); i++)
+  {
+    std::vector<JitBlock*>* entry = map.Find(i * 0x100);
+    if (i % 2 == 0)
+    {
+      EXPECT_EQ(nullptr, entry);
+    }
+    else
+    {
+      ASSERT_NE(nullptr, entry);
+      ASSERT_EQ(1u, entry->size());
+      EXPECT_EQ(&blocks[i], entry->front());
+    }
+  }
+
+  std::vector<u32> keys;
+  map.CollectKeys(0x100, 0x4FF, &keys);
+  std::sort(keys.begin(), keys.end());
+  EXPECT_EQ((std::vector<u32>{0x100, 0x300}), keys);
+}
+
+// Simulates a game which keeps invalidating and recompiling the same code.
+TEST(BlockRangeMap, InvalidationChurn)
+{
+  BlockRangeMap map;
+  std::vector<JitBlock> blocks(0x100);
+
+  for (int iteration = 0; iteration < 100; iteration++)
+  {
+    for (u32 i = 0; i < blocks.size(); i++)
+      map[0x80000000 + i * 0x100].push_back(&blocks[i]);
+    for (u32 i = 0; i < blocks.size(); i++)
+      map.Erase(0x80000000 + i * 0x100);
+  }
+
+  EXPECT_EQ(nullptr, map.Find(0x80000000));
+  EXPECT_GE(map.Capacity(), blocks.size());
+}
+
+// The churn of a game which keeps invalidating and recompiling the same code, with many blocks
+// sharing each macro block.
+TEST(JitCacheTables, Churn)
+{
+  constexpr u32 NUM_BLOCKS = 0x1000;
+  const auto address = [](u32 i) { return 0x80000000 + i * 0x24; };
+  const auto macro_block = [](u32 i) { return (0x80000000 + i * 0x24) & ~0xFFu; };
+
+  std::vector<Node> nodes(NUM_BLOCKS);
+  std::vector<JitBlock> blocks(NUM_BLOCKS);
+  for (u32 i = 0; i < NUM_BLOCKS; i++)
+    nodes[i].key = address(i);
+
+  NodeTable table;
+  BlockRangeMap range_map;
+  for (int iteration = 0; iteration < 10; iteration++)
+  {
+    for (u32 i = 0; i < NUM_BLOCKS; i++)
+    {
+      table.Insert(&nodes[i]);
+      range_map[macro_block(i)].push_back(&blocks[i]);
+    }
+    for (u32 i = 0; i < NUM_BLOCKS; i++)
+    {
+      EXPECT_EQ(&nodes[i], table.Find(address(i), [](const Node&) { return true; }));
+      std::vector<JitBlock*>* entry = range_map.Find(macro_block(i));
+      ASSERT_NE(nullptr, entry);
+      EXPECT_NE(entry->end(), std::find(entry->begin(), entry->end(), &blocks[i]));
+    }
+    for (u32 i = 0; i < NUM_BLOCKS; i++)
+    {
+      table.Erase(&nodes[i]);
+      range_map.Erase(macro_block(i));
+    }
+    for (u32 i = 0; i < NUM_BLOCKS; i++)
+    {
+      EXPECT_EQ(nullptr, table.Find(address(i), [](const Node&) { return true; }));
+      EXPECT_EQ(nullptr, range_map.Find(macro_block(i)));
+    }
+  }
+}
@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <functional>
 #include <gtest/gtest.h>
 #include <string>
 #include <unordered_set>
@@ -138,3 +139,65 @@ TEST_F(MappingTest, ReadWriteComplex)
   EXPECT_TRUE(read_called);
   EXPECT_TRUE(write_called);
 }
+
+TEST_F(MappingTest, ReadShifted)
+{
+  u32 counter = 0;
+  m_mapping->Register(0x0C001234, MMIO::ShiftedRead<u16>(&counter, 1, 1), MMIO::Nop<u16>());
+
+  for (u32 value : {0u, 1u, 2u, 3u, 0x1FFFFu, 0xFFFFFFFFu})
+  {
+    counter = value;
+    EXPECT_EQ(static_cast<u16>(1 + (value - 1) / 2), m_mapping->Read<u16>(0x0C001234));
+  }
+}
+
+namespace
+{
+// Checks whether a handler was turned into a Direct handling method.
+template <typename T>
+struct IsDirectVisitor : public MMIO::ReadHandlingMethodVisitor<T>
+{
+  void VisitConstant(T) override {}
+  void VisitDirect(const T*, u32) override { is_direct = true; }
+  void VisitShifted(const u32*, u32, u32) override {}
+  void VisitComplex(const std::function<T(u32)>*) override {}
+  bool is_direct = false;
+};
+}  // Anonymous namespace
+
+TEST_F(MappingTest, ReadToSmallerCombinesDirectHalves)
+{
+  u32 target = 0;
+  m_mapping->Register(0x0C001234, MMIO::DirectRead<u16>(MMIO::Utils::HighPart(&target)),
+                      MMIO::Nop<u16>());
+  m_mapping->Register(0x0C001236, MMIO::DirectRead<u16>(MMIO::Utils::LowPart(&target), 0xFFE0),
+                      MMIO::Nop<u16>());
+  m_mapping->Register(0x0C001234, MMIO::ReadToSmaller<u32>(m_mapping, 0x0C001234, 0x0C001236),
+                      MMIO::Nop<u32>());
+
+  IsDirectVisitor<u32> visitor;
+  m_mapping->GetHandlerForRead<u32>(0x0C001234).Visit(visitor);
+  EXPECT_TRUE(visitor.is_direct);
+
+  target = 0x12345678;
+  EXPECT_EQ(0x12345660u, m_mapping->Read<u32>(0x0C001234));
+}
+
+TEST_F(MappingTest, ReadToLargerSplitsDirect)
+{
+  u32 target = 0;
+  m_mapping->Register(0x0C001234, MMIO::DirectRead<u32>(&target, 0xFFFF00FF), MMIO::Nop<u32>());
+  m_mapping->Register(0x0C001234, MMIO::ReadToLarger<u16>(m_mapping, 0x0C001234, 16),
+                      MMIO::Nop<u16>());
+  m_mapping->Register(0x0C001236, MMIO::ReadToLarger<u16>(m_mapping, 0x0C001234, 0),
+                      MMIO::Nop<u16>());
+
+  IsDirectVisitor<u16> visitor;
+  m_mapping->GetHandlerForRead<u16>(0x0C001236).Visit(visitor);
+  EXPECT_TRUE(visitor.is_direct);
+
+  target = 0x12345678;
+  EXPECT_EQ(0x1234, m_mapping->Read<u16>(0x0C001234));
+  EXPECT_EQ(0x0078, m_mapping->Read<u16>(0x0C001236));
+}
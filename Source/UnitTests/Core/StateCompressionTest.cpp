@@ -0,0 +1,74 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <lzo/lzo1x.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/StateCompression.h"
+#include "TestUtil.h"
+
+namespace
+{
+// Partly compressible data which doesn't end on a chunk boundary.
+std::vector<u8> MakeState()
+{
+  std::vector<u8> state(0x123456);
+  TestUtil::Random random;
+  for (size_t i = 0; i < state.size(); i++)
+  {
+    const u8 random_byte = random.NextByte();
+    state[i] = (i & 0x10000) ? random_byte : static_cast<u8>(i / 64);
+  }
+  return state;
+}
+}  // Anonymous namespace
+
+TEST(StateCompression, RoundTrip)
+{
+  ASSERT_EQ(LZO_E_OK, lzo_init());
+  const std::vector<u8> state = MakeState();
+  const std::vector<u8> compressed = State::CompressState(state.data(), state.size());
+  EXPECT_LT(compressed.size(), state.size());
+
+  std::vector<u8> result;
+  ASSERT_TRUE(State::DecompressState(compressed.data(), compressed.size(), state.size(), &result));
+  EXPECT_EQ(state, result);
+
+  EXPECT_FALSE(
+      State::DecompressState(compressed.data(), compressed.size() - 1, state.size(), &result));
+  EXPECT_FALSE(
+      State::DecompressState(compressed.data(), compressed.size(), state.size() + 1, &result));
+}
+
+// The stream of LZO chunks which older versions wrote must still be readable.
+TEST(StateCompression, LegacyLZOStream)
+{
+  ASSERT_EQ(LZO_E_OK, lzo_init());
+  const std::vector<u8> state = MakeState();
+  const size_t chunk_size = 128 * 1024;
+  std::vector<u8> wrkmem(LZO1X_1_MEM_COMPRESS);
+  std::vector<u8> out(chunk_size + chunk_size / 16 + 64 + 3);
+
+  std::vector<u8> stream;
+  for (size_t i = 0; i < state.size(); i += chunk_size)
+  {
+    lzo_uint out_len = 0;
+    const size_t length = std::min(chunk_size, state.size() - i);
+    ASSERT_EQ(LZO_E_OK,
+              lzo1x_1_compress(&state[i], length, out.data(), &out_len, wrkmem.data()));
+
+    const u32 size = static_cast<u32>(out_len);
+    stream.insert(stream.end(), reinterpret_cast<const u8*>(&size),
+                  reinterpret_cast<const u8*>(&size) + sizeof(size));
+    stream.insert(stream.end(), out.begin(), out.begin() + out_len);
+  }
+
+  std::vector<u8> result;
+  ASSERT_TRUE(State::DecompressState(stream.data(), stream.size(), state.size(), &result));
+  EXPECT_EQ(state, result);
+}
@@ -0,0 +1,225 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/StateDelta.h"
+#include "StateTestUtil.h"
+
+using TestUtil::MakeState;
+
+namespace
+{
+constexpr u32 RAM_SIZE = 0x40000;
+
+// State files kept in memory. They are saved and loaded the way SaveAs and LoadAs do it with
+// deltas enabled, minus the compression.
+class StateFiles
+{
+public:
+  void Save(const std::string& filename, const std::vector<u8>& header, std::vector<u8>& ram)
+  {
+    m_files[filename] = m_saver.Save(filename, MakeState(header, ram));
+  }
+
+  // Returns the emulated RAM of the state, or an empty vector on failure.
+  std::vector<u8> Load(const std::string& filename)
+  {
+    std::vector<std::string> chain;
+    std::vector<u8> buffer = Read(filename, &chain);
+    if (buffer.empty())
+      return {};
+
+    State::RecordedState state;
+    std::vector<u8> header;
+    std::vector<u8> ram(RAM_SIZE);
+    u8* ptr = buffer.data();
+    PointerWrap p(&ptr, PointerWrap::MODE_READ);
+    p.RecordLargeArrays(&state.large_arrays);
+    p.Do(header);
+    p.DoArray(ram.data(), RAM_SIZE);
+    state.buffer = std::move(buffer);
+    m_saver.SetLoaded(std::move(chain), std::move(state));
+    return ram;
+  }
+
+  bool IsDeltaState(const std::string& filename) { return State::IsDeltaState(m_files[filename]); }
+  const std::string& GetError() const { return m_error; }
+
+private:
+  std::vector<u8> Read(const std::string& filename, std::vector<std::string>* chain)
+  {
+    chain->push_back(filename);
+    std::vector<u8> data = m_files[filename];
+    if (State::IsDeltaState(data))
+    {
+      const auto read_base = [this](const std::string& base, std::vector<std::string>* files) {
+        return Read(base, files);
+      };
+      if (!State::ResolveDeltaState(filename, &data, chain, read_base, &m_error))
+        return {};
+    }
+    return data;
+  }
+
+  std::map<std::string, std::vector<u8>> m_files;
+  State::DeltaStateSaver m_saver;
+  std::string m_error;
+};
+}  // Anonymous namespace
+
+TEST(StateDelta, OnlyChangedPagesAreStored)
+{
+  std::vector<u8> ram(RAM_SIZE, 0x11);
+  const State::RecordedState base = MakeState({1, 2, 3}, ram);
+  ASSERT_EQ(1u, base.large_arrays.size());
+
+  // The larger header moves the array, which must still be lined up with the base.
+  ram[0x1234] = 0x22;
+  ram[RAM_SIZE - 1] = 0x33;
+  const State::RecordedState state = MakeState({1, 2, 3, 4, 5, 6, 7}, ram);
+
+  const std::vector<u8> delta = State::EncodeDelta(base, state);
+  EXPECT_LT(delta.size(), 0x3000u);
+
+  std::vector<u8> result;
+  ASSERT_TRUE(State::ApplyDelta(base.buffer, delta.data(), delta.size(), &result));
+  EXPECT_EQ(state.buffer, result);
+}
+
+TEST(StateDelta, RejectsOtherBase)
+{
+  std::vector<u8> ram(RAM_SIZE, 0x11);
+  const State::RecordedState base = MakeState({1}, ram);
+  ram[0] = 0x22;
+  const State::RecordedState state = MakeState({1}, ram);
+  const std::vector<u8> delta = State::EncodeDelta(base, state);
+
+  std::vector<u8> result;
+  EXPECT_FALSE(State::ApplyDelta(state.buffer, delta.data(), delta.size(), &result));
+  EXPECT_FALSE(State::ApplyDelta(base.buffer, delta.data(), delta.size() - 1, &result));
+}
+
+TEST(StateDelta, Chain)
+{
+  std::vector<u8> ram(RAM_SIZE, 0);
+  State::RecordedState previous = MakeState({}, ram);
+  const std::vector<u8> first = previous.buffer;
+  std::vector<std::vector<u8>> deltas;
+
+  for (u8 i = 1; i <= 4; i++)
+  {
+    ram[i * 0x8000] = i;
+    State::RecordedState state = MakeState(std::vector<u8>(i, i), ram);
+    deltas.push_back(State::EncodeDelta(previous, state));
+    previous = std::move(state);
+  }
+
+  std::vector<u8> buffer = first;
+  for (const std::vector<u8>& delta : deltas)
+  {
+    std::vector<u8> next;
+    ASSERT_TRUE(State::ApplyDelta(buffer, delta.data(), delta.size(), &next));
+    buffer.swap(next);
+  }
+  EXPECT_EQ(previous.buffer, buffer);
+}
+
+TEST(StateDelta, SavingOverAnAncestorWritesAFullState)
+{
+  // Save slot 1 (full), then slot 2 (a delta against slot 1), then slot 1 again.
+  State::DeltaChain chain;
+  EXPECT_FALSE(chain.CanSaveDelta("slot1"));
+  chain.Reset({"slot1"});
+  ASSERT_TRUE(chain.CanSaveDelta("slot2"));
+  chain.AddDelta("slot2");
+  EXPECT_EQ("slot2", chain.GetBase());
+
+  // A delta in slot 1 would refer to slot 2, which refers to slot 1.
+  EXPECT_FALSE(chain.CanSaveDelta("slot1"));
+  EXPECT_FALSE(chain.CanSaveDelta("slot2"));
+  EXPECT_TRUE(chain.CanSaveDelta("slot3"));
+
+  // Loading a state starts over from the files it was loaded through.
+  chain.Reset({"slot3", "slot2", "slot1"});
+  EXPECT_EQ("slot3", chain.GetBase());
+  EXPECT_FALSE(chain.CanSaveDelta("slot1"));
+  EXPECT_TRUE(chain.CanSaveDelta("slot4"));
+}
+
+TEST(StateDelta, ChainLengthIsLimited)
+{
+  State::DeltaChain chain;
+  chain.Reset({"0"});
+  for (size_t i = 1; i < State::MAX_DELTA_CHAIN_LENGTH; i++)
+  {
+    const std::string filename = std::to_string(i);
+    ASSERT_TRUE(chain.CanSaveDelta(filename));
+    chain.AddDelta(filename);
+  }
+  EXPECT_FALSE(chain.CanSaveDelta("last"));
+}
+
+TEST(StateDelta, SaveAndLoadThroughDeltaStates)
+{
+  StateFiles files;
+  std::vector<u8> ram(RAM_SIZE, 0x11);
+  files.Save("states/slot1", {1}, ram);
+  EXPECT_FALSE(files.IsDeltaState("states/slot1"));
+
+  std::vector<std::vector<u8>> saved_ram{ram};
+  for (u8 i = 2; i <= 3; i++)
+  {
+    ram[i * 0x9000] = i;
+    files.Save("states/slot" + std::to_string(i), std::vector<u8>(i, i), ram);
+    EXPECT_TRUE(files.IsDeltaState("states/slot" + std::to_string(i)));
+    saved_ram.push_back(ram);
+  }
+
+  for (u8 i = 3; i >= 1; i--)
+    EXPECT_EQ(saved_ram[i - 1], files.Load("states/slot" + std::to_string(i))) << int(i);
+}
+
+TEST(StateDelta, SaveADeltaAfterLoadingAFullState)
+{
+  StateFiles files;
+  std::vector<u8> ram(RAM_SIZE, 0x11);
+  files.Save("slot1", {}, ram);
+  const std::vector<u8> slot1_ram = ram;
+  ram[0x100] = 0x22;
+  files.Save("slot2", {}, ram);
+
+  // The next delta is made against the state which was loaded last, not the one saved last.
+  ASSERT_EQ(slot1_ram, files.Load("slot1"));
+  ram = slot1_ram;
+  ram[RAM_SIZE - 1] = 0x33;
+  files.Save("slot3", {4, 5}, ram);
+  EXPECT_TRUE(files.IsDeltaState("slot3"));
+
+  EXPECT_EQ(ram, files.Load("slot3"));
+  EXPECT_EQ(slot1_ram, files.Load("slot1"));
+}
+
+TEST(StateDelta, LoadingFailsAfterTheBaseSlotChanged)
+{
+  StateFiles files;
+  std::vector<u8> ram(RAM_SIZE, 0x11);
+  files.Save("slot1", {}, ram);
+  ram[0x100] = 0x22;
+  files.Save("slot2", {}, ram);
+
+  // Slot 1 is part of the chain of slot 2, so it is saved in full, and slot 2 is left behind.
+  ram[0x200] = 0x44;
+  files.Save("slot1", {}, ram);
+  EXPECT_FALSE(files.IsDeltaState("slot1"));
+  EXPECT_EQ(ram, files.Load("slot1"));
+
+  EXPECT_TRUE(files.Load("slot2").empty());
+  EXPECT_EQ("Delta state doesn't match its base state slot1", files.GetError());
+}
@@ -0,0 +1,95 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <lzo/lzo1x.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/StateRewind.h"
+#include "StateTestUtil.h"
+#include "TestUtil.h"
+
+using TestUtil::MakeState;
+
+namespace
+{
+constexpr u32 RAM_SIZE = 0x100000;
+}  // Anonymous namespace
+
+TEST(RewindBuffer, StepsBackInOrder)
+{
+  ASSERT_EQ(LZO_E_OK, lzo_init());
+  State::RewindBuffer buffer(0x10000000);
+  std::vector<u8> ram(RAM_SIZE);
+  TestUtil::FillRandom(ram.data(), ram.size(), 1);
+
+  std::vector<std::vector<u8>> states;
+  for (u8 i = 0; i < 5; i++)
+  {
+    ram[i * 0x10000] ^= 0xFF;
+    State::RecordedState state = MakeState(std::vector<u8>(i, i), ram);
+    states.push_back(state.buffer);
+    buffer.Push(std::move(state));
+  }
+
+  // Only the first snapshot and one page per later snapshot should have been stored.
+  EXPECT_LT(buffer.GetMemoryUsage(), RAM_SIZE + 0x10000);
+
+  for (size_t i = states.size(); i-- > 0;)
+  {
+    std::vector<u8> state;
+    ASSERT_TRUE(buffer.Pop(&state));
+    EXPECT_EQ(states[i], state);
+  }
+
+  std::vector<u8> state;
+  EXPECT_FALSE(buffer.Pop(&state));
+}
+
+TEST(RewindBuffer, DropsOldestSnapshots)
+{
+  ASSERT_EQ(LZO_E_OK, lzo_init());
+  State::RewindBuffer buffer(RAM_SIZE * 3);
+  std::vector<u8> ram(RAM_SIZE);
+
+  std::vector<u8> newest;
+  for (u32 i = 0; i < 8; i++)
+  {
+    TestUtil::FillRandom(ram.data(), ram.size(), i);
+    State::RecordedState state = MakeState({}, ram);
+    newest = state.buffer;
+    buffer.Push(std::move(state));
+    EXPECT_LE(buffer.GetMemoryUsage(), RAM_SIZE * 3);
+  }
+  EXPECT_EQ(2u, buffer.GetSnapshotCount());
+
+  std::vector<u8> state;
+  ASSERT_TRUE(buffer.Pop(&state));
+  EXPECT_EQ(newest, state);
+
+  buffer.Clear();
+  EXPECT_EQ(0u, buffer.GetSnapshotCount());
+  EXPECT_EQ(0u, buffer.GetMemoryUsage());
+}
+
+TEST(RewindBuffer, PushReturnsPreviousBuffer)
+{
+  ASSERT_EQ(LZO_E_OK, lzo_init());
+  State::RewindBuffer buffer(0x10000000);
+  std::vector<u8> ram(RAM_SIZE);
+  TestUtil::FillRandom(ram.data(), ram.size(), 1);
+
+  EXPECT_TRUE(buffer.Push(MakeState({1}, ram)).empty());
+
+  // The buffer of the first snapshot can be reused, as the second one has replaced it.
+  const std::vector<u8> first = MakeState({1}, ram).buffer;
+  ram[0] ^= 0xFF;
+  EXPECT_EQ(first, buffer.Push(MakeState({2}, ram)));
+
+  std::vector<u8> state;
+  ASSERT_TRUE(buffer.Pop(&state));
+  EXPECT_EQ(MakeState({2}, ram).buffer, state);
+}
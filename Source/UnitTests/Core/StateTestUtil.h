@@ -0,0 +1,31 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+#include "Core/StateDelta.h"
+
+namespace TestUtil
+{
+// Writes a state which consists of some variable sized data and an array like emulated RAM.
+inline State::RecordedState MakeState(std::vector<u8> header, std::vector<u8>& ram)
+{
+  State::RecordedState state;
+  for (PointerWrap::Mode mode : {PointerWrap::MODE_MEASURE, PointerWrap::MODE_WRITE})
+  {
+    u8* ptr = state.buffer.data();
+    PointerWrap p(&ptr, mode);
+    if (mode == PointerWrap::MODE_WRITE)
+      p.RecordLargeArrays(&state.large_arrays);
+    p.Do(header);
+    p.DoArray(ram.data(), static_cast<u32>(ram.size()));
+    state.buffer.resize(ptr - state.buffer.data());
+  }
+  return state;
+}
+}
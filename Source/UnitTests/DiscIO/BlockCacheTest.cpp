@@ -0,0 +1,120 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/BlockCache.h"
+#include "DiscImageTest.h"
+#include "TestUtil.h"
+
+namespace
+{
+DiscIO::BlockCache::Chunk MakeChunk(size_t size, u8 value)
+{
+  return std::make_shared<const std::vector<u8>>(size, value);
+}
+
+using CachedBlobTest = TestUtil::DiscImageTest;
+}  // Anonymous namespace
+
+TEST(BlockCache, FindsInsertedChunks)
+{
+  DiscIO::BlockCache cache(0x1000);
+  cache.Insert(0, 5, MakeChunk(0x100, 1));
+  cache.Insert(1, 5, MakeChunk(0x100, 2));
+
+  ASSERT_NE(nullptr, cache.Find(0, 5));
+  EXPECT_EQ(1, cache.Find(0, 5)->front());
+  EXPECT_EQ(2, cache.Find(1, 5)->front());
+  EXPECT_EQ(nullptr, cache.Find(0, 6));
+  EXPECT_TRUE(cache.Contains(1, 5));
+  EXPECT_FALSE(cache.Contains(2, 5));
+  EXPECT_EQ(0x200u, cache.GetSize());
+
+  cache.Insert(0, 5, MakeChunk(0x80, 3));
+  EXPECT_EQ(3, cache.Find(0, 5)->front());
+  EXPECT_EQ(0x180u, cache.GetSize());
+}
+
+TEST(BlockCache, EvictsLeastRecentlyUsed)
+{
+  DiscIO::BlockCache cache(0x300);
+  cache.Insert(0, 0, MakeChunk(0x100, 0));
+  cache.Insert(0, 1, MakeChunk(0x100, 1));
+  cache.Insert(0, 2, MakeChunk(0x100, 2));
+
+  const DiscIO::BlockCache::Chunk first = cache.Find(0, 0);
+  cache.Insert(0, 3, MakeChunk(0x100, 3));
+  EXPECT_TRUE(cache.Contains(0, 0));
+  EXPECT_FALSE(cache.Contains(0, 1));
+  EXPECT_EQ(0x300u, cache.GetSize());
+
+  // Evicted chunks stay valid for whoever still holds them.
+  cache.SetCapacity(0x100);
+  EXPECT_FALSE(cache.Contains(0, 0));
+  EXPECT_TRUE(cache.Contains(0, 3));
+  EXPECT_EQ(0x100u, first->size());
+
+  // A chunk larger than the whole cache isn't kept.
+  cache.Insert(0, 4, MakeChunk(0x200, 4));
+  EXPECT_FALSE(cache.Contains(0, 4));
+  EXPECT_TRUE(cache.Contains(0, 3));
+}
+
+TEST(BlockCache, EraseOnlyRemovesChunksOfOwner)
+{
+  DiscIO::BlockCache cache(0x1000);
+  for (u64 i = 0; i < 4; i++)
+  {
+    cache.Insert(0, i, MakeChunk(0x100, 0));
+    cache.Insert(1, i, MakeChunk(0x100, 1));
+  }
+
+  cache.Erase(0);
+  for (u64 i = 0; i < 4; i++)
+  {
+    EXPECT_FALSE(cache.Contains(0, i));
+    EXPECT_TRUE(cache.Contains(1, i));
+  }
+  EXPECT_EQ(0x400u, cache.GetSize());
+}
+
+TEST_F(CachedBlobTest, CompressedBlobReads)
+{
+  const std::string gcz_path = m_temp_dir + "/disc.gcz";
+
+  // Random data and compressible data, over enough blocks for reads to be batched.
+  std::vector<u8> disc(0x200000);
+  TestUtil::Random random;
+  for (size_t i = 0; i < disc.size(); i++)
+  {
+    const u8 random_byte = random.NextByte();
+    disc[i] = i % 0x8000 < 0x2000 ? random_byte : static_cast<u8>(i / 64);
+  }
+  WritePlainImage(disc);
+  ASSERT_TRUE(DiscIO::CompressFileToBlob(m_plain_path, gcz_path, 0, 0x4000,
+                                         [](const std::string&, float, void*) { return true; }));
+
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(gcz_path);
+  ASSERT_NE(nullptr, reader);
+  ASSERT_EQ(DiscIO::BlobType::GCZ, reader->GetBlobType());
+
+  // Unaligned reads which partially hit blocks that are already cached.
+  std::vector<u8> result(disc.size());
+  ASSERT_TRUE(reader->Read(0x5123, 0x100, result.data()));
+  EXPECT_TRUE(std::equal(result.begin(), result.begin() + 0x100, disc.begin() + 0x5123));
+  ASSERT_TRUE(reader->Read(0x4FF0, 0x64321, result.data()));
+  EXPECT_TRUE(std::equal(result.begin(), result.begin() + 0x64321, disc.begin() + 0x4FF0));
+
+  ASSERT_TRUE(reader->Read(0, result.size(), result.data()));
+  EXPECT_EQ(disc, result);
+  EXPECT_FALSE(reader->Read(disc.size() - 0x10, 0x20, result.data()));
+}
@@ -0,0 +1,115 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/BlockDecompressor.h"
+#include "DiscImageTest.h"
+#include "TestUtil.h"
+
+namespace
+{
+constexpr u32 BLOCK_SIZE = 0x4000;
+
+bool IgnoreProgress(const std::string&, float, void*)
+{
+  return true;
+}
+
+// Random data, zeroes and compressible data, not ending on a block boundary.
+std::vector<u8> MakeDisc(size_t size)
+{
+  std::vector<u8> disc(size);
+  TestUtil::Random random;
+  for (size_t i = 0; i < disc.size(); i++)
+  {
+    const u8 random_byte = random.NextByte();
+    const size_t region = i / 0x30000 % 3;
+    if (region == 0)
+      disc[i] = random_byte;
+    else if (region == 2)
+      disc[i] = static_cast<u8>(i / 64);
+  }
+  return disc;
+}
+
+class CompressedBlobTest : public TestUtil::DiscImageTest
+{
+protected:
+  void SetUp() override
+  {
+    DiscImageTest::SetUp();
+    m_gcz_path = m_temp_dir + "/disc.gcz";
+  }
+
+  void Compress(const std::vector<u8>& disc)
+  {
+    WritePlainImage(disc);
+    ASSERT_TRUE(DiscIO::CompressFileToBlob(m_plain_path, m_gcz_path, 0, BLOCK_SIZE,
+                                           IgnoreProgress, nullptr));
+  }
+
+  std::string m_gcz_path;
+};
+}  // Anonymous namespace
+
+TEST_F(CompressedBlobTest, RoundTrip)
+{
+  const std::vector<u8> disc = MakeDisc(0x123456);
+  Compress(disc);
+  EXPECT_LT(File::GetSize(m_gcz_path), disc.size());
+
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(m_gcz_path);
+  ASSERT_NE(nullptr, reader);
+  EXPECT_EQ(DiscIO::BlobType::GCZ, reader->GetBlobType());
+  ASSERT_EQ(disc.size(), reader->GetDataSize());
+
+  std::vector<u8> result(disc.size());
+  ASSERT_TRUE(reader->Read(0, result.size(), result.data()));
+  EXPECT_EQ(disc, result);
+  reader.reset();
+
+  const std::string decompressed_path = m_temp_dir + "/decompressed.iso";
+  ASSERT_TRUE(DiscIO::DecompressBlobToFile(m_gcz_path, decompressed_path, IgnoreProgress, nullptr));
+  std::fill(result.begin(), result.end(), 0);
+  File::IOFile decompressed(decompressed_path, "rb");
+  ASSERT_EQ(disc.size(), decompressed.GetSize());
+  ASSERT_TRUE(decompressed.ReadBytes(result.data(), result.size()));
+  EXPECT_EQ(disc, result);
+}
+
+TEST(BlockDecompressor, RunsEveryTaskOnce)
+{
+  DiscIO::BlockDecompressor decompressor(3);
+  std::array<std::array<std::atomic<u32>, 100>, 2> calls{};
+
+  // Two threads hand batches to the same workers at once.
+  const auto run_batches = [&](size_t thread_index) {
+    for (int batch = 0; batch < 50; batch++)
+    {
+      decompressor.Run(calls[thread_index].size(),
+                       [&](u64 task_index) { calls[thread_index][task_index]++; });
+    }
+  };
+  std::thread other_thread(run_batches, 1);
+  run_batches(0);
+  other_thread.join();
+
+  for (const auto& thread_calls : calls)
+  {
+    for (const std::atomic<u32>& task_calls : thread_calls)
+      EXPECT_EQ(50u, task_calls.load());
+  }
+}
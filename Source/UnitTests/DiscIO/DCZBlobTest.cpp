@@ -0,0 +1,188 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <mbedtls/aes.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Swap.h"
+#include "Core/IOS/ES/Formats.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/Enums.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeWii.h"
+#include "DiscImageTest.h"
+#include "TestUtil.h"
+
+namespace
+{
+constexpr u64 PARTITION_OFFSET = 0x50000;
+constexpr u64 PARTITION_DATA_OFFSET = 0x20000;
+constexpr u32 NUM_PARTITION_BLOCKS = 8;
+
+void WriteBE32(std::vector<u8>* disc, u64 offset, u32 value)
+{
+  const u32 swapped = Common::swap32(value);
+  std::memcpy(&(*disc)[offset], &swapped, sizeof(swapped));
+}
+
+// Random data followed by zeroes and then compressible data, not ending on a chunk boundary.
+std::vector<u8> MakeGameCubeDisc()
+{
+  std::vector<u8> disc(0x2C1234);
+  TestUtil::Random random;
+  for (size_t i = 0; i < disc.size(); i++)
+  {
+    const u8 random_byte = random.NextByte();
+    if (i < 0x80000)
+      disc[i] = random_byte;
+    else if (i >= 0x180000)
+      disc[i] = static_cast<u8>(i / 64);
+  }
+  WriteBE32(&disc, 0x1C, 0xC2339F3D);
+  return disc;
+}
+
+// A disc with a single partition whose data is compressible once it is decrypted.
+std::vector<u8> MakeWiiDisc(std::vector<u8>* decrypted_data)
+{
+  const u64 data_offset = PARTITION_OFFSET + PARTITION_DATA_OFFSET;
+  std::vector<u8> disc(data_offset +
+                       (NUM_PARTITION_BLOCKS + 1) * DiscIO::VolumeWii::BLOCK_TOTAL_SIZE);
+  WriteBE32(&disc, 0x18, 0x5D1C9EA3);
+  WriteBE32(&disc, 0x40000, 1);
+  WriteBE32(&disc, 0x40004, 0x40020 >> 2);
+  WriteBE32(&disc, 0x40020, PARTITION_OFFSET >> 2);
+
+  std::vector<u8> ticket(sizeof(IOS::ES::Ticket));
+  WriteBE32(&ticket, 0, 0x00010001);
+  std::fill(ticket.begin() + offsetof(IOS::ES::Ticket, title_key),
+            ticket.begin() + offsetof(IOS::ES::Ticket, title_key) + 16, 0x5A);
+  std::copy(ticket.begin(), ticket.end(), disc.begin() + PARTITION_OFFSET);
+  WriteBE32(&disc, PARTITION_OFFSET + 0x2b8, PARTITION_DATA_OFFSET >> 2);
+  WriteBE32(&disc, PARTITION_OFFSET + 0x2bc,
+            (NUM_PARTITION_BLOCKS * DiscIO::VolumeWii::BLOCK_TOTAL_SIZE) >> 2);
+
+  const std::array<u8, 16> title_key = IOS::ES::TicketReader{std::move(ticket)}.GetTitleKey();
+  mbedtls_aes_context key;
+  mbedtls_aes_setkey_enc(&key, title_key.data(), 128);
+
+  decrypted_data->clear();
+  for (u32 i = 0; i < NUM_PARTITION_BLOCKS; i++)
+  {
+    u8* block = &disc[data_offset + i * DiscIO::VolumeWii::BLOCK_TOTAL_SIZE];
+    for (u32 j = 0; j < DiscIO::VolumeWii::BLOCK_TOTAL_SIZE; j++)
+      block[j] = static_cast<u8>((i * 7 + j / 256) & 0xFF);
+    decrypted_data->insert(decrypted_data->end(), block + DiscIO::VolumeWii::BLOCK_HEADER_SIZE,
+                           block + DiscIO::VolumeWii::BLOCK_TOTAL_SIZE);
+
+    u8 iv[16] = {};
+    mbedtls_aes_crypt_cbc(&key, MBEDTLS_AES_ENCRYPT, DiscIO::VolumeWii::BLOCK_HEADER_SIZE, iv,
+                          block, block);
+    std::copy_n(&block[0x3D0], sizeof(iv), iv);
+    mbedtls_aes_crypt_cbc(&key, MBEDTLS_AES_ENCRYPT, DiscIO::VolumeWii::BLOCK_DATA_SIZE, iv,
+                          &block[DiscIO::VolumeWii::BLOCK_HEADER_SIZE],
+                          &block[DiscIO::VolumeWii::BLOCK_HEADER_SIZE]);
+  }
+
+  return disc;
+}
+
+class DCZBlobTest : public TestUtil::DiscImageTest
+{
+protected:
+  void SetUp() override
+  {
+    DiscImageTest::SetUp();
+    m_dcz_path = m_temp_dir + "/disc.dcz";
+  }
+
+  void Convert(const std::vector<u8>& disc)
+  {
+    WritePlainImage(disc);
+    ASSERT_TRUE(DiscIO::ConvertToDCZ(m_plain_path, m_dcz_path));
+  }
+
+  std::string m_dcz_path;
+};
+}  // Anonymous namespace
+
+TEST_F(DCZBlobTest, GameCubeRoundTrip)
+{
+  const std::vector<u8> disc = MakeGameCubeDisc();
+  Convert(disc);
+  EXPECT_LT(File::GetSize(m_dcz_path), disc.size() / 2);
+
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(m_dcz_path);
+  ASSERT_NE(nullptr, reader);
+  EXPECT_EQ(DiscIO::BlobType::DCZ, reader->GetBlobType());
+  EXPECT_FALSE(reader->SupportsReadWiiDecrypted());
+  ASSERT_EQ(disc.size(), reader->GetDataSize());
+
+  std::vector<u8> result(disc.size());
+  ASSERT_TRUE(reader->Read(0, result.size(), result.data()));
+  EXPECT_EQ(disc, result);
+
+  // Reads which span chunks and start in the middle of them.
+  ASSERT_TRUE(reader->Read(0x1FFF0, 0x40020, result.data()));
+  EXPECT_TRUE(std::equal(result.begin(), result.begin() + 0x40020, disc.begin() + 0x1FFF0));
+}
+
+TEST_F(DCZBlobTest, WiiPartitionIsStoredDecrypted)
+{
+  std::vector<u8> decrypted_data;
+  const std::vector<u8> disc = MakeWiiDisc(&decrypted_data);
+  Convert(disc);
+  EXPECT_LT(File::GetSize(m_dcz_path), disc.size() / 4);
+
+  std::unique_ptr<DiscIO::BlobReader> reader = DiscIO::CreateBlobReader(m_dcz_path);
+  ASSERT_NE(nullptr, reader);
+  EXPECT_TRUE(reader->SupportsReadWiiDecrypted());
+
+  std::vector<u8> result(disc.size());
+  ASSERT_TRUE(reader->Read(0, result.size(), result.data()));
+  EXPECT_EQ(disc, result);
+
+  // The plain image is decrypted by VolumeWii, the DCZ image by the blob reader.
+  const DiscIO::Partition partition(PARTITION_OFFSET);
+  for (const std::string& path : {m_plain_path, m_dcz_path})
+  {
+    std::unique_ptr<DiscIO::Volume> volume = DiscIO::CreateVolumeFromFilename(path);
+    ASSERT_NE(nullptr, volume);
+    ASSERT_EQ(DiscIO::Platform::WII_DISC, volume->GetVolumeType());
+    result.resize(decrypted_data.size());
+    ASSERT_TRUE(volume->Read(0, result.size(), result.data(), partition));
+    EXPECT_EQ(decrypted_data, result);
+  }
+}
+
+TEST_F(DCZBlobTest, WiiReadsPastStoredDataAreDecrypted)
+{
+  std::vector<u8> decrypted_data;
+  const std::vector<u8> disc = MakeWiiDisc(&decrypted_data);
+  Convert(disc);
+
+  // The last block on the disc isn't part of the partition data, so it isn't stored decrypted,
+  // but a plain image can still be read there.
+  const DiscIO::Partition partition(PARTITION_OFFSET);
+  const u64 size = (NUM_PARTITION_BLOCKS + 1) * DiscIO::VolumeWii::BLOCK_DATA_SIZE - 0x10;
+  std::vector<std::vector<u8>> results;
+  for (const std::string& path : {m_plain_path, m_dcz_path})
+  {
+    std::unique_ptr<DiscIO::Volume> volume = DiscIO::CreateVolumeFromFilename(path);
+    ASSERT_NE(nullptr, volume);
+    results.emplace_back(size);
+    ASSERT_TRUE(volume->Read(0x10, size, results.back().data(), partition));
+  }
+  EXPECT_EQ(results[0], results[1]);
+  EXPECT_TRUE(std::equal(decrypted_data.begin() + 0x10, decrypted_data.end(), results[1].begin()));
+}
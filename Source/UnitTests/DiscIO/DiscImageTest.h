@@ -0,0 +1,38 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+
+namespace TestUtil
+{
+// A fixture for tests which convert disc images. Every test gets a directory of its own
+// which is removed again afterwards, along with everything that was written to it.
+class DiscImageTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_temp_dir = File::CreateTempDir();
+    m_plain_path = m_temp_dir + "/disc.iso";
+  }
+
+  void TearDown() override { File::DeleteDirRecursively(m_temp_dir); }
+  void WritePlainImage(const std::vector<u8>& disc)
+  {
+    ASSERT_TRUE(File::IOFile(m_plain_path, "wb").WriteBytes(disc.data(), disc.size()));
+  }
+
+  std::string m_temp_dir;
+  std::string m_plain_path;
+};
+}
@@ -0,0 +1,46 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Helpers shared by the tests of several components.
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace TestUtil
+{
+// A linear congruential generator, so that a test gets the same data on every platform.
+class Random
+{
+public:
+  explicit Random(u32 seed = 1) : m_state(seed) {}
+  u32 Next()
+  {
+    m_state = m_state * 1103515245 + 12345;
+    return m_state;
+  }
+  u8 NextByte() { return static_cast<u8>(Next() >> 16); }
+
+private:
+  u32 m_state;
+};
+
+inline void FillRandom(u8* data, size_t size, u32 seed = 1)
+{
+  Random random(seed);
+  for (size_t i = 0; i < size; i++)
+    data[i] = random.NextByte();
+}
+
+// Data which doesn't compress.
+inline std::vector<u8> RandomBytes(size_t size, u32 seed = 1)
+{
+  std::vector<u8> data(size);
+  FillRandom(data.data(), data.size(), seed);
+  return data;
+}
+}